@@ -0,0 +1,1104 @@
+// Benchmarks for both assignments. By default the microbenchmark suite runs: bignum
+// operations across bit widths and scheduler admission and dispatch across queue sizes,
+// all with fixed seeds, printed as a table and optionally written as JSON so results can
+// be compared between commits. --reports runs the longer reports; the correctness tests,
+// the allocation check among them, are in Tests.cpp.
+//
+// Usage: assignment_benchmarks [--filter=<substring>] [--json=<file>] [--min-time=<seconds>]
+//                              [--list] [--reports]
+//        assignment_benchmarks --replay <trace>   (used by the reports, in a child process)
+#include "LargeNumber.h"
+#include "ProcessScheduler.h"
+#include "TestSupport.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <random>
+#include <type_traits>
+#include <cstdlib>
+#include <climits>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/wait.h>
+#ifdef LARGE_NUMBER_X86
+#include <x86intrin.h>
+#endif
+using namespace std;
+
+// Function to time how long op takes to run the given number of iterations, in nanoseconds
+// per iteration; op may take the iteration index or nothing
+template <typename Op>
+double timeOperation(int iterations, Op op) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        if constexpr (is_invocable_v<Op, int>) {
+            op(i);
+        } else {
+            op();
+        }
+    }
+    auto elapsed = chrono::steady_clock::now() - start;
+    return chrono::duration<double, nano>(elapsed).count() / iterations;
+}
+
+// Print one benchmark line
+void reportBenchmark(const string& name, double nanosPerOp) {
+    cout << name << ": " << nanosPerOp << " ns/op" << endl;
+}
+
+// Benchmark the fixed-width backend against the linked-list LargeNumber
+void benchmarkStorageBackends() {
+    volatile bool sink = false; // Keeps the compiler from dropping the work
+
+    LargeNumber listA, listB, listM;
+    listA.generateRandom();
+    listB.generateRandom();
+    listM.generateRandom();
+    reportBenchmark("list   1024 operator+", timeOperation(100000, [&] { LargeNumber r = listA + listB; sink = r.isZero(); }));
+    reportBenchmark("list   1024 operator>=", timeOperation(100000, [&] { sink = listA >= listB; }));
+    reportBenchmark("list   1024 subtract", timeOperation(100000, [&] { LargeNumber r = listA; r.subtract(listB); sink = r.isZero(); }));
+    reportBenchmark("list   1024 modMul", timeOperation(100, [&] { LargeNumber r = listA.modMul(listB, listM); sink = r.isZero(); }));
+
+    LargeNumber1024 fixedA, fixedB, fixedM;
+    fixedA.generateRandom();
+    fixedB.generateRandom();
+    fixedM.generateRandom();
+    reportBenchmark("fixed  1024 operator+", timeOperation(100000, [&] { LargeNumber1024 r = fixedA + fixedB; sink = r.isZero(); }));
+    reportBenchmark("fixed  1024 operator>=", timeOperation(100000, [&] { sink = fixedA >= fixedB; }));
+    reportBenchmark("fixed  1024 subtract", timeOperation(100000, [&] { LargeNumber1024 r = fixedA; r.subtract(fixedB); sink = r.isZero(); }));
+    reportBenchmark("fixed  1024 modMul", timeOperation(100, [&] { LargeNumber1024 r = fixedA.modMul(fixedB, fixedM); sink = r.isZero(); }));
+
+    LargeNumber2048 fixed2048A, fixed2048B, fixed2048M;
+    fixed2048A.generateRandom();
+    fixed2048B.generateRandom();
+    fixed2048M.generateRandom();
+    reportBenchmark("fixed  2048 modMul", timeOperation(100, [&] { LargeNumber2048 r = fixed2048A.modMul(fixed2048B, fixed2048M); sink = r.isZero(); }));
+
+    LargeNumber4096 fixed4096A, fixed4096B, fixed4096M;
+    fixed4096A.generateRandom();
+    fixed4096B.generateRandom();
+    fixed4096M.generateRandom();
+    reportBenchmark("fixed  4096 modMul", timeOperation(20, [&] { LargeNumber4096 r = fixed4096A.modMul(fixed4096B, fixed4096M); sink = r.isZero(); }));
+}
+
+// Find a probable prime of the given width by stepping through odd numbers from a random start
+template <int Bits>
+FixedLargeNumber<Bits> findPrime() {
+    FixedLargeNumber<Bits> candidate;
+    candidate.generateRandom();
+    candidate.setLimb(0, candidate.limb(0) | 1); // Start from an odd number
+    while (!candidate.isPrime()) {
+        candidate = candidate + FixedLargeNumber<Bits>(2);
+    }
+    return candidate;
+}
+
+// Report Miller-Rabin throughput at one width, for random odd candidates and for a prime
+template <int Bits>
+void benchmarkPrimalityThroughput() {
+    volatile bool sink = false;
+    string width = to_string(Bits);
+
+    FixedLargeNumber<Bits> candidate;
+    candidate.generateRandom();
+    candidate.setLimb(0, candidate.limb(0) | 1);
+    int candidates = 200;
+    double nanos = timeOperation(candidates, [&] {
+        sink = candidate.isPrime();
+        candidate = candidate + FixedLargeNumber<Bits>(2); // Next odd candidate
+    });
+    cout << "montgomery " << width << " isPrime random odd: " << 1e9 / nanos << " tests/s" << endl;
+
+    FixedLargeNumber<Bits> prime = findPrime<Bits>();
+    nanos = timeOperation(Bits >= 2048 ? 5 : 20, [&] { sink = prime.isPrime(); });
+    cout << "montgomery " << width << " isPrime prime (5 rounds): " << 1e9 / nanos << " tests/s" << endl;
+}
+
+// Benchmark Montgomery multiplication against modMul, and primality throughput
+void benchmarkMontgomery() {
+    volatile bool sink = false;
+
+    LargeNumber1024 a, b, m;
+    a.generateRandom();
+    b.generateRandom();
+    m.generateRandom();
+    m.setLimb(0, m.limb(0) | 1); // Montgomery needs an odd modulus
+    b = b.mod(m);
+    MontgomeryContext<1024> context(m);
+    MontgomeryContext<1024> constantTimeContext(m, true);
+    LargeNumber1024 aM = context.toMontgomery(a);
+    LargeNumber1024 bM = context.toMontgomery(b);
+    reportBenchmark("divide     1024 modMul", timeOperation(100, [&] { sink = a.modMul(b, m).isZero(); }));
+    reportBenchmark("montgomery 1024 multiply", timeOperation(100000, [&] { sink = context.multiply(aM, bM).isZero(); }));
+    reportBenchmark("montgomery 1024 modPow", timeOperation(50, [&] { sink = context.modPow(a, b).isZero(); }));
+    reportBenchmark("montgomery 1024 modPow constant-time", timeOperation(50, [&] { sink = constantTimeContext.modPow(a, b).isZero(); }));
+
+    benchmarkPrimalityThroughput<1024>();
+    benchmarkPrimalityThroughput<2048>();
+}
+
+// Compare sliding-window widths and fixed-base table reuse for 1024-bit exponents
+void benchmarkWindowedExponentiation() {
+    volatile bool sink = false;
+
+    LargeNumber1024 base, exponent, m;
+    base.generateRandom();
+    exponent.generateRandom();
+    m.generateRandom();
+    m.setLimb(0, m.limb(0) | 1);
+    MontgomeryContext<1024> context(m);
+    LargeNumber1024 baseM = context.toMontgomery(base);
+    for (int window = 1; window <= MontgomeryContext<1024>::max_window_bits; ++window) {
+        reportBenchmark("montgomery 1024 modPow window " + to_string(window),
+                        timeOperation(50, [&] { sink = context.powMontgomery(baseM, exponent, window).isZero(); }));
+    }
+    FixedBasePowTable<1024> table(context, base);
+    reportBenchmark("montgomery 1024 modPow fixed-base table", timeOperation(50, [&] { sink = table.powMontgomery(exponent).isZero(); }));
+}
+
+// Scaling of isPrime(rounds, threads) on a 1024-bit prime, where every round has to run
+void benchmarkParallelPrimality() {
+    volatile bool sink = false;
+    const int rounds = 32;
+    int maxThreads = (int)thread::hardware_concurrency();
+    if (maxThreads < 4) maxThreads = 4;
+
+    LargeNumber1024 prime = findPrime<1024>();
+    double serial = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        double nanos = timeOperation(3, [&] { sink = prime.isPrime(rounds, threads); });
+        if (threads == 1) serial = nanos;
+        cout << "parallel 1024 isPrime " << rounds << " rounds, " << threads << " threads: "
+             << 1e9 / nanos << " tests/s (speedup " << serial / nanos << "x)" << endl;
+    }
+}
+
+// Reproducible prime candidates at one width: consecutive odd numbers from a random start,
+// mostly composite, with a few known primes mixed in at even spacing
+template <int Bits>
+vector<FixedLargeNumber<Bits>> primeCandidates(int count, int primes) {
+    vector<FixedLargeNumber<Bits>> candidates, found;
+    if (primes > 0) found = PrimeSearch<Bits>(4).findPrimes(primes);
+    FixedLargeNumber<Bits> candidate;
+    candidate.generateRandom();
+    candidate.setLimb(0, candidate.limb(0) | 1);
+    for (int i = 0; i < count; ++i) {
+        if (primes > 0 && i % (count / primes) == 0 && i / (count / primes) < primes) {
+            candidates.push_back(found[i / (count / primes)]);
+            continue;
+        }
+        candidates.push_back(candidate);
+        candidate = candidate + FixedLargeNumber<Bits>(2); // Next odd candidate
+    }
+    return candidates;
+}
+
+// Candidates per second through isPrime in a loop against isPrimeBatch at each supported
+// instruction set, at one width
+template <int Bits>
+void benchmarkPrimalityBatchAt(int count, int primes) {
+    vector<FixedLargeNumber<Bits>> candidates = primeCandidates<Bits>(count, primes);
+    string width = to_string(Bits);
+    auto start = chrono::steady_clock::now();
+    for (const FixedLargeNumber<Bits>& candidate : candidates) candidate.isPrime();
+    double loopSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "primality " << width << " isPrime loop: " << count / loopSeconds << " candidates/s" << endl;
+
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+        if (level > detectSimdLevel()) break;
+        MillerRabinBatch<Bits> batch(5, level);
+        start = chrono::steady_clock::now();
+        batch.test(candidates);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "primality " << width << " isPrimeBatch (" << simdLevelName(level) << "): " << count / seconds
+             << " candidates/s (" << loopSeconds / seconds << "x)" << endl;
+    }
+}
+
+// Batched Miller-Rabin against the one-at-a-time loop
+void benchmarkPrimalityBatch() {
+    benchmarkPrimalityBatchAt<1024>(512, 8);
+    benchmarkPrimalityBatchAt<2048>(128, 4);
+    benchmarkPrimalityBatchAt<4096>(32, 2);
+}
+
+// Primes found per second: generateRandom + isPrime loop against the sieving pipeline
+void benchmarkPrimeSearch() {
+    const int primesWanted = 16;
+
+    auto start = chrono::steady_clock::now();
+    int found = 0;
+    long long drawn = 0;
+    while (found < primesWanted) {
+        LargeNumber1024 candidate;
+        candidate.generateRandom();
+        drawn++;
+        if (candidate.isPrime()) found++;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "prime search 1024 naive loop: " << found / seconds << " primes/s (" << drawn << " candidates)" << endl;
+
+    int maxThreads = (int)thread::hardware_concurrency();
+    if (maxThreads < 1) maxThreads = 1;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        PrimeSearch<1024> search(threads);
+        start = chrono::steady_clock::now();
+        vector<LargeNumber1024> primes = search.findPrimes(primesWanted);
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "prime search 1024 sieve pipeline, " << threads << " threads: " << primes.size() / seconds
+             << " primes/s (" << search.candidatesExamined() << " candidates, "
+             << search.candidatesTested() << " sent to Miller-Rabin)" << endl;
+    }
+}
+
+// Limbs generated per second: the old srand/rand path against the per-thread generators
+void benchmarkRandomSources() {
+    const int numbers = 20000;
+    volatile bool sink = false;
+    double nanos;
+
+    nanos = timeOperation(numbers, [&] {
+        uint64_t limbs[LargeNumber1024::limb_count];
+        srand(time(nullptr)); // What generateRandom used to do on every call
+        for (int i = 0; i < LargeNumber1024::limb_count; ++i) limbs[i] = ((uint64_t)rand() << 32) | rand();
+        sink = limbs[0] == 0;
+    });
+    cout << "random srand/rand: " << 1e9 * LargeNumber1024::limb_count / nanos << " limbs/s" << endl;
+
+    seedThreadRandom(42); // Fixed seed so the runs are reproducible
+    LargeNumber1024 number;
+    nanos = timeOperation(numbers, [&] { number.generateRandom(); sink = number.isZero(); });
+    cout << "random xoshiro256** (thread-local): " << 1e9 * LargeNumber1024::limb_count / nanos << " limbs/s" << endl;
+
+    ChaCha20Random secure(42);
+    nanos = timeOperation(numbers, [&] { number.generateRandom(secure); sink = number.isZero(); });
+    cout << "random chacha20: " << 1e9 * LargeNumber1024::limb_count / nanos << " limbs/s" << endl;
+}
+
+// Long division and Barrett reduction of a double-width value at one operand size
+template <int Bits>
+void benchmarkReductionAt() {
+    volatile bool sink = false;
+    string width = to_string(Bits);
+
+    FixedLargeNumber<2 * Bits> dividend;
+    dividend.generateRandom();
+    FixedLargeNumber<Bits> m, a, b;
+    m.generateRandom();
+    a.generateRandom();
+    b.generateRandom();
+    a = a.mod(m);
+    b = b.mod(m);
+    BarrettContext<Bits> barrett(m);
+    FixedLargeNumber<2 * Bits> quotient;
+    FixedLargeNumber<Bits> remainder;
+    reportBenchmark("divmod  " + width + " (" + to_string(2 * Bits) + "-bit dividend)",
+                    timeOperation(10000, [&] { dividend.divmod(m, quotient, remainder); sink = remainder.isZero(); }));
+    reportBenchmark("barrett " + width + " reduce", timeOperation(10000, [&] { sink = barrett.reduce(dividend).isZero(); }));
+    reportBenchmark("modMul  " + width + " (divide)", timeOperation(10000, [&] { sink = a.modMul(b, m).isZero(); }));
+    reportBenchmark("modMul  " + width + " (barrett)", timeOperation(10000, [&] { sink = barrett.multiply(a, b).isZero(); }));
+}
+
+// Reduction microbenchmarks from 256 to 4096-bit operands
+void benchmarkReduction() {
+    benchmarkReductionAt<256>();
+    benchmarkReductionAt<512>();
+    benchmarkReductionAt<1024>();
+    benchmarkReductionAt<2048>();
+    benchmarkReductionAt<4096>();
+}
+
+// Time one full-size product with the given Karatsuba threshold, in nanoseconds
+double timeKaratsubaThreshold(int limbCount, int threshold, bool squaring) {
+    vector<uint64_t> a(limbCount), b(limbCount), product(2 * limbCount), scratch(karatsubaScratchLimbs(limbCount) + 1);
+    threadRandom().fill(a.data(), limbCount);
+    threadRandom().fill(b.data(), limbCount);
+    int saved = karatsuba_threshold;
+    karatsuba_threshold = threshold;
+    double nanos = timeOperation(2000, [&] {
+        multiplyKaratsuba(a.data(), squaring ? a.data() : b.data(), limbCount, product.data(), scratch.data());
+    });
+    karatsuba_threshold = saved;
+    return nanos;
+}
+
+// Karatsuba crossover tuning: multiply and square at several sizes for each candidate
+// threshold (a threshold above the size is plain schoolbook) and report the fastest
+void benchmarkKaratsubaCrossover() {
+    const int thresholds[] = {8, 12, 16, 24, 32, 48, 64, 1 << 30};
+    const int sizes[] = {16, 32, 64, 128}; // 1024 to 8192-bit operands
+    for (int squaring = 0; squaring <= 1; ++squaring) {
+        for (int limbCount : sizes) {
+            int bestThreshold = 0;
+            double bestNanos = 0;
+            for (int threshold : thresholds) {
+                double nanos = timeKaratsubaThreshold(limbCount, threshold, squaring);
+                string label = threshold > limbCount ? string("schoolbook") : "threshold " + to_string(threshold);
+                reportBenchmark(string(squaring ? "square   " : "multiply ") + to_string(64 * limbCount) + " " + label, nanos);
+                if (bestThreshold == 0 || nanos < bestNanos) {
+                    bestThreshold = threshold;
+                    bestNanos = nanos;
+                }
+                if (threshold > limbCount) break; // Larger thresholds are all schoolbook
+            }
+            cout << "fastest " << (squaring ? "square " : "multiply ") << 64 * limbCount << ": "
+                 << (bestThreshold > limbCount ? string("schoolbook") : "threshold " + to_string(bestThreshold)) << endl;
+        }
+    }
+}
+
+// Unit the carry kernel report is given in: timestamp counter cycles on x86, else nanoseconds
+#ifdef LARGE_NUMBER_X86
+const char* limb_cost_unit = "cycles/limb";
+#else
+const char* limb_cost_unit = "ns/limb";
+#endif
+
+// Function to time op, which processes limbs limbs, as the best of twenty runs after a warm-up
+template <typename Op>
+double costPerLimb(long long limbs, Op op) {
+    op();
+    double best = 0;
+    for (int run = 0; run < 20; ++run) {
+#ifdef LARGE_NUMBER_X86
+        uint64_t start = __rdtsc();
+        op();
+        double cost = double(__rdtsc() - start) / limbs;
+#else
+        auto start = chrono::steady_clock::now();
+        op();
+        double cost = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / limbs;
+#endif
+        if (run == 0 || cost < best) best = cost;
+    }
+    return best;
+}
+
+// Function to benchmark the carry kernels per limb: the comparison-based reference loop
+// against the ADC/SBB kernels, and the batched add at each supported instruction set
+void benchmarkCarryKernels() {
+    const long long totalLimbs = 1 << 20; // Limbs processed per run
+    volatile uint64_t sink = 0;
+    for (int length : {16, 32, 64}) {
+        vector<uint64_t> a(length), b(length);
+        threadRandom().fill(a.data(), length);
+        threadRandom().fill(b.data(), length);
+        uint64_t* x = a.data();
+        const uint64_t* y = b.data();
+        long long repeats = totalLimbs / length;
+        double reference = costPerLimb(totalLimbs, [=, &sink] {
+            uint64_t total = 0;
+            for (long long r = 0; r < repeats; ++r) total += referenceAdd(x, y, length, x);
+            sink = total;
+        });
+        double add = costPerLimb(totalLimbs, [=, &sink] {
+            uint64_t total = 0;
+            for (long long r = 0; r < repeats; ++r) total += addLimbsInPlace(x, length, y, length);
+            sink = total;
+        });
+        double subtract = costPerLimb(totalLimbs, [=, &sink] {
+            uint64_t total = 0;
+            for (long long r = 0; r < repeats; ++r) total += subtractLimbsInPlace(x, length, y, length);
+            sink = total;
+        });
+        double compare = costPerLimb(totalLimbs, [=, &sink] {
+            uint64_t total = 0;
+            for (long long r = 0; r < repeats; ++r) total += limbsAtLeast(x, y, length);
+            sink = total;
+        });
+        cout << "carry kernels " << 64 * length << "-bit: reference add " << reference << ", addLimbsInPlace " << add
+             << ", subtractLimbsInPlace " << subtract << ", limbsAtLeast " << compare << " " << limb_cost_unit << endl;
+    }
+    const int length = 16, count = 1024; // 1024 independent 1024-bit additions
+    vector<uint64_t> a(length * count), b(length * count), carries(count);
+    threadRandom().fill(a.data(), length * count);
+    threadRandom().fill(b.data(), length * count);
+    long long repeats = totalLimbs / (length * count);
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+        if (level > detectSimdLevel()) break;
+        double batched = costPerLimb(totalLimbs, [&] {
+            for (long long r = 0; r < repeats; ++r) addLimbsBatch(a.data(), b.data(), length, count, carries.data(), level);
+        });
+        cout << "carry kernels batched add " << count << " x 1024-bit (" << simdLevelName(level) << "): "
+             << batched << " " << limb_cost_unit << endl;
+    }
+}
+
+// Function to benchmark process add/complete churn: one process node plus one completed-list
+// copy per job with new/delete (the previous path) against the scheduler's ProcessPool
+void benchmarkProcessChurn() {
+    const int jobs = 1000000;
+    const int live = 64;  // Processes in flight at any time
+    vector<Process*> inFlight(live, nullptr);
+
+    double heapNanos = timeOperation(jobs, [&](int i) {
+        Process*& slot = inFlight[i % live];
+        if (slot) {  // Complete the oldest process: copy it to the completed list, free both
+            Process* completed = new Process(slot->process_id, 0);
+            delete slot;
+            delete completed;
+        }
+        slot = new Process(i, 10);  // Admit a new process
+    });
+    for (Process*& slot : inFlight) {
+        delete slot;
+        slot = nullptr;
+    }
+
+    ProcessPool pool;
+    double poolNanos = timeOperation(jobs, [&](int i) {
+        Process*& slot = inFlight[i % live];
+        if (slot) {  // Complete the oldest process: the node itself is recycled
+            pool.release(slot);
+        }
+        slot = pool.acquire(i, 10);  // Admit a new process
+    });
+
+    cout << "process churn new/delete: " << heapNanos << " ns/job (" << 1e9 / heapNanos << " jobs/s)" << endl;
+    cout << "process churn pool:       " << poolNanos << " ns/job (" << 1e9 / poolNanos << " jobs/s, "
+         << pool.slabCount() << " slab)" << endl;
+}
+
+// Function to benchmark admission throughput at several queue depths: one-by-one addProcess
+// with the tail pointer, bulk addProcesses, and bulk admission into the ring-buffer queue
+void benchmarkAdmission() {
+    const int sizes[] = {1000, 100000, 1000000};
+    for (int size : sizes) {
+        vector<ProcessSpec> specs(size);
+        for (int i = 0; i < size; i++) {
+            specs[i] = {i, 1 + i % 20};
+        }
+
+        auto start = chrono::steady_clock::now();
+        {
+            ProcessScheduler scheduler;
+            for (const ProcessSpec& spec : specs) {
+                scheduler.addProcess(spec.process_id, spec.execution_time);
+            }
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "admission " << size << " addProcess:        " << size / seconds << " processes/s" << endl;
+        }
+
+        start = chrono::steady_clock::now();
+        {
+            ProcessScheduler scheduler;
+            scheduler.addProcesses(specs);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "admission " << size << " addProcesses:      " << size / seconds << " processes/s" << endl;
+        }
+
+        start = chrono::steady_clock::now();
+        {
+            RingProcessScheduler scheduler;
+            scheduler.addProcesses(specs);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "admission " << size << " ring addProcesses: " << size / seconds << " processes/s" << endl;
+        }
+    }
+}
+
+// Function to benchmark the multi-core scheduler: producers add processes while the cores
+// run; the multicore_scheduler test checks the per-process results
+void benchmarkMultiCore() {
+    const int processes = 200000;
+    const int producers = 2;
+    vector<int> executionTimes(processes);
+    mt19937 random(12345);  // Fixed seed so every run sees the same workload
+    for (int i = 0; i < processes; i++) {
+        executionTimes[i] = 1 + (int)(random() % 60);
+    }
+
+    int maxCores = max(4, (int)thread::hardware_concurrency());
+    for (int coreCount = 1; coreCount <= maxCores; coreCount *= 2) {
+        MultiCoreScheduler scheduler(coreCount);
+        auto start = chrono::steady_clock::now();
+        scheduler.start();
+        vector<thread> producerThreads;
+        for (int p = 0; p < producers; p++) {
+            producerThreads.emplace_back([&, p] {
+                for (int i = p; i < processes; i += producers) {
+                    scheduler.addProcess(i, executionTimes[i]);
+                }
+            });
+        }
+        for (thread& producer : producerThreads) producer.join();
+        scheduler.finish();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "multicore " << coreCount << " cores: " << processes / seconds << " processes/s" << endl;
+        scheduler.displayStats();
+    }
+}
+
+// Function to time the cycle-by-cycle loop on a moderate workload and fastForward on
+// millions of long jobs; the fast_forward test checks that the two agree
+void benchmarkFastForward() {
+    mt19937 random(2024);  // Fixed seed so every run sees the same workload
+    const int loopProcesses = 20000;
+    vector<ProcessSpec> specs(loopProcesses);
+    long long quanta = 0;
+    for (int i = 0; i < loopProcesses; i++) {
+        specs[i] = {i, (int)(random() % 3000)};  // Includes zero-length processes
+        quanta += max(1, (specs[i].execution_time + 2) / 3);
+    }
+
+    NullEventSink quiet;  // Skip the per-cycle output of the loop
+    ProcessScheduler loopScheduler;
+    loopScheduler.setEventSink(quiet);
+    loopScheduler.addProcesses(specs);
+    auto start = chrono::steady_clock::now();
+    loopScheduler.simulate();
+    double loopSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "cycle loop:   " << loopSeconds << " s for " << quanta << " quanta" << endl;
+
+    const int longProcesses = 2000000;
+    vector<ProcessSpec> longSpecs(longProcesses);
+    for (int i = 0; i < longProcesses; i++) {
+        longSpecs[i] = {i, 1 + (int)(random() % 1000000)};
+    }
+    ProcessScheduler scheduler;
+    scheduler.addProcesses(longSpecs);
+    start = chrono::steady_clock::now();
+    vector<CompletionEvent> events = scheduler.fastForward();
+    double fastSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "fast-forward: " << fastSeconds << " s for " << longProcesses << " processes over "
+         << events.back().cycle << " cycles (" << longProcesses / fastSeconds << " completions/s)" << endl;
+}
+
+// Function to run the same mixed workload under every scheduling policy: interactive
+// jobs (priority 0, 1-6 units) arrive among batch jobs (priority 2, 50-500 units)
+void benchmarkPolicies() {
+    const int processes = 20000;
+    mt19937 random(99);  // Fixed seed so every run sees the same workload
+    vector<ProcessSpec> workload(processes);
+    int arrival = 0;
+    for (int i = 0; i < processes; i++) {
+        bool interactive = random() % 10 < 8;
+        arrival += (int)(random() % 136);  // Mean service time is about 58 units: roughly 85% load
+        workload[i] = {i, interactive ? 1 + (int)(random() % 6) : 50 + (int)(random() % 451),
+                       interactive ? 0 : 2, arrival};
+    }
+
+    RoundRobinPolicy roundRobin3(3), roundRobin10(10);
+    ShortestRemainingTimePolicy shortestRemaining;
+    MultilevelFeedbackPolicy feedback;
+    SchedulingPolicy* policies[] = {&roundRobin3, &roundRobin10, &shortestRemaining, &feedback};
+    for (SchedulingPolicy* policy : policies) {
+        PolicyScheduler scheduler(*policy);
+        PolicyReport report = scheduler.run(workload);
+        cout << "policy " << report.policy << ": turnaround avg " << report.averageTurnaround
+             << " p99 " << report.p99Turnaround << ", waiting avg " << report.averageWaiting
+             << " p99 " << report.p99Waiting << ", " << report.contextSwitches << " slices" << endl;
+    }
+}
+
+// Function to benchmark trace ingestion: write a CSV trace, convert it to the binary
+// format, time reading each, then replay the binary trace under round robin
+void benchmarkTraceReplay() {
+    const int records = 2000000;
+    filesystem::path directory = filesystem::temp_directory_path();
+    string csvPath = (directory / "scheduler_trace.csv").string();
+    string binaryPath = (directory / "scheduler_trace.bin").string();
+
+    {
+        FILE* csv = fopen(csvPath.c_str(), "w");
+        if (!csv) {
+            cout << "trace: could not create " << csvPath << endl;
+            return;
+        }
+        mt19937 random(7);  // Fixed seed so every run sees the same trace
+        fprintf(csv, "arrival_time,process_id,execution_time,priority\n");
+        int arrival = 0;
+        for (int i = 0; i < records; i++) {
+            arrival += (int)(random() % 12);  // Mean burst is 5 units: roughly 85% load
+            fprintf(csv, "%d,%d,%d,%d\n", arrival, i, 1 + (int)(random() % 9), (int)(random() % 3));
+        }
+        fclose(csv);
+    }
+
+    auto start = chrono::steady_clock::now();
+    long long converted = convertCsvTrace(csvPath, binaryPath);
+    double convertSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Function to time a full read of a trace and check it returns every record
+    auto timeRead = [&](const string& path) {
+        unique_ptr<TraceReader> trace = openTrace(path);
+        ProcessSpec record{0, 0};
+        long long checksum = 0;
+        auto readStart = chrono::steady_clock::now();
+        while (trace->next(record)) checksum += record.process_id;
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - readStart).count();
+        bool complete = trace->recordCount() == records && checksum == (long long)records * (records - 1) / 2;
+        cout << (complete ? "" : "INCOMPLETE ") << trace->recordCount() / seconds << " records/s" << endl;
+    };
+    cout << "trace convert CSV to binary: " << converted << " records, " << converted / convertSeconds << " records/s" << endl;
+    cout << "trace read CSV:    ";
+    timeRead(csvPath);
+    cout << "trace read binary: ";
+    timeRead(binaryPath);
+
+    // The peak RSS of this process was set by earlier reports, so the replay runs in a
+    // fresh copy of this program that reports its own peak
+    cout.flush();
+    pid_t child = fork();
+    if (child == 0) {
+        execl("/proc/self/exe", "assignment_benchmarks", "--replay", binaryPath.c_str(), (char*)nullptr);
+        _exit(127);  // exec failed
+    }
+    int status = 0;
+    if (child < 0 || waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        cout << "trace replay: the child process failed" << endl;
+    }
+
+    filesystem::remove(csvPath);
+    filesystem::remove(binaryPath);
+}
+
+// Function to replay a trace under round robin and report records/s and the peak RSS of
+// this process, before and after; run by benchmarkTraceReplay in a fresh process
+int replayTraceReport(const string& path) {
+    long rssBefore = peakResidentKilobytes();
+    unique_ptr<TraceReader> trace = openTrace(path);
+    if (!trace->isOpen()) {
+        cout << "trace replay: could not open " << path << endl;
+        return 1;
+    }
+    RoundRobinPolicy roundRobin(3);
+    PolicyScheduler scheduler(roundRobin);
+    auto start = chrono::steady_clock::now();
+    PolicyReport report = scheduler.replay(*trace);
+    double replaySeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    long rssAfter = peakResidentKilobytes();
+    cout << "trace replay " << report.policy << ": " << trace->recordCount() / replaySeconds
+         << " records/s, turnaround avg " << report.averageTurnaround << " p99 " << report.p99Turnaround << endl;
+    cout << "trace peak RSS: " << rssAfter << " KB in a fresh process, " << rssAfter - rssBefore
+         << " KB above the " << rssBefore << " KB it started with" << endl;
+    return 0;
+}
+
+// Function to compare simulation throughput with each event sink on the same 100K-process
+// workload; the console sink writes to a file here, and the old per-line endl printing
+// is timed too for reference
+void benchmarkEventSinks() {
+    const int processes = 100000;
+    vector<ProcessSpec> specs(processes);
+    mt19937 random(5);  // Fixed seed so every run sees the same workload
+    for (int i = 0; i < processes; i++) {
+        specs[i] = {i, 1 + (int)(random() % 30)};
+    }
+    filesystem::path directory = filesystem::temp_directory_path();
+    string logPath = (directory / "scheduler_events.log").string();
+    string csvPath = (directory / "scheduler_events.csv").string();
+    string binaryPath = (directory / "scheduler_events.bin").string();
+
+    // Function to simulate the workload into a sink and report events per second
+    auto timeSink = [&](const string& name, EventSink& sink) {
+        ProcessScheduler scheduler;
+        scheduler.setEventSink(sink);
+        scheduler.addProcesses(specs);
+        auto start = chrono::steady_clock::now();
+        scheduler.simulate();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        long long runs = 0;  // One run event per quantum handed out
+        for (const ProcessSpec& spec : specs) runs += max(1, (spec.execution_time + 2) / 3);
+        cout << "event sink " << name << runs * 2 / seconds << " events/s (" << seconds << " s)" << endl;
+    };
+
+    NullEventSink nullSink;
+    timeSink("null:    ", nullSink);
+    {
+        CsvEventSink csvSink(csvPath);
+        timeSink("CSV:     ", csvSink);
+    }
+    {
+        BinaryEventSink binarySink(binaryPath);
+        timeSink("binary:  ", binarySink);
+    }
+    {
+        ofstream log(logPath);
+        ConsoleEventSink consoleSink(log);
+        timeSink("console: ", consoleSink);
+    }
+    {
+        // The previous printer: the same text, but endl after every line
+        class FlushingConsoleSink : public ConsoleEventSink {
+        private:
+            ostream& out;
+        public:
+            FlushingConsoleSink(ostream& out) : ConsoleEventSink(out), out(out) {}
+            void snapshotFinished() override {
+                ConsoleEventSink::snapshotFinished();
+                out.flush();
+            }
+            void record(const SchedulerEvent& event) override {
+                ConsoleEventSink::record(event);
+                if (event.type == EventType::Run) out.flush();
+            }
+        };
+        ofstream log(logPath);
+        FlushingConsoleSink flushingSink(log);
+        timeSink("endl:    ", flushingSink);
+    }
+    filesystem::remove(logPath);
+    filesystem::remove(csvPath);
+    filesystem::remove(binaryPath);
+}
+
+// Function to print the scheduler's own metrics for a 100K-process workload with the null
+// sink, so the dispatch overhead is the scheduler's alone
+void benchmarkSchedulerMetrics() {
+    const int processes = 100000;
+    vector<ProcessSpec> specs(processes);
+    mt19937 random(11);  // Fixed seed so every run sees the same workload
+    for (int i = 0; i < processes; i++) {
+        specs[i] = {i, 1 + (int)(random() % 30)};
+    }
+    NullEventSink nullSink;
+    ProcessScheduler scheduler;
+    scheduler.setEventSink(nullSink);
+    scheduler.addProcesses(specs);
+    scheduler.simulate();
+    cout << "scheduler metrics, " << processes << " processes:" << endl;
+    scheduler.stats().dump(cout);
+}
+
+// One microbenchmark. prepare() builds the inputs and returns the body; body(iterations)
+// runs the operation that many times and returns the number of items it processed.
+struct Microbenchmark {
+    string name;
+    function<function<long long(long long)>()> prepare;
+};
+
+// Measured result of one microbenchmark
+struct MicrobenchmarkResult {
+    string name;
+    long long iterations;
+    double nanosPerIteration;
+    double itemsPerSecond;
+};
+
+// Function to run a microbenchmark with a growing iteration count until one run takes
+// at least minSeconds, and report that run
+MicrobenchmarkResult runMicrobenchmark(const Microbenchmark& benchmark, double minSeconds) {
+    seedThreadRandom(1);  // Every benchmark sees the same inputs whatever else runs
+    function<long long(long long)> body = benchmark.prepare();
+    long long iterations = 1;
+    while (true) {
+        auto start = chrono::steady_clock::now();
+        long long items = body(iterations);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (seconds >= minSeconds || iterations >= (1LL << 40)) {
+            return {benchmark.name, iterations, seconds * 1e9 / iterations, items / seconds};
+        }
+        double scale = seconds > 0 ? min(10.0, 1.4 * minSeconds / seconds) : 10.0;  // Aim past the minimum time
+        iterations = max(iterations + 1, (long long)(iterations * scale));
+    }
+}
+
+// Function to register modMul, Montgomery modPow and isPrime at one width
+template <int Bits>
+void addBignumBenchmarks(vector<Microbenchmark>& benchmarks) {
+    string width = to_string(Bits);
+    benchmarks.push_back({"bignum/fixed/" + width + "/modMul", [] {
+        auto a = make_shared<FixedLargeNumber<Bits>>(), b = make_shared<FixedLargeNumber<Bits>>();
+        auto m = make_shared<FixedLargeNumber<Bits>>();
+        a->generateRandom();
+        b->generateRandom();
+        m->generateRandom();
+        return function<long long(long long)>([=](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                *a = a->modMul(*b, *m);  // Feed each product into the next
+            }
+            return iterations;
+        });
+    }});
+    benchmarks.push_back({"bignum/fixed/" + width + "/modPow", [] {
+        auto base = make_shared<FixedLargeNumber<Bits>>(), exponent = make_shared<FixedLargeNumber<Bits>>();
+        auto m = make_shared<FixedLargeNumber<Bits>>();
+        base->generateRandom();
+        exponent->generateRandom();
+        m->generateRandom();
+        m->setLimb(0, m->limb(0) | 1);  // Odd modulus: the Montgomery path
+        return function<long long(long long)>([=](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                *base = base->modPow(*exponent, *m);
+            }
+            return iterations;
+        });
+    }});
+    // Consecutive odd candidates per iteration for the loop and batch comparison, fewer at larger widths
+    int candidateCount = Bits >= 4096 ? 8 : Bits >= 2048 ? 32 : 64;
+    benchmarks.push_back({"bignum/fixed/" + width + "/isPrime/candidates", [=] {
+        auto candidates = make_shared<vector<FixedLargeNumber<Bits>>>(primeCandidates<Bits>(candidateCount, 0));
+        return function<long long(long long)>([=](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                for (const FixedLargeNumber<Bits>& candidate : *candidates) candidate.isPrime();  // Each call draws witnesses, so it is not dropped
+            }
+            return iterations * candidateCount;
+        });
+    }});
+    benchmarks.push_back({"bignum/fixed/" + width + "/isPrimeBatch/candidates", [=] {
+        auto candidates = make_shared<vector<FixedLargeNumber<Bits>>>(primeCandidates<Bits>(candidateCount, 0));
+        return function<long long(long long)>([=](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                isPrimeBatch<Bits>(*candidates);
+            }
+            return iterations * candidateCount;
+        });
+    }});
+    benchmarks.push_back({"bignum/fixed/" + width + "/isPrime/prime", [] {
+        PrimeSearch<Bits> search(1);
+        auto prime = make_shared<FixedLargeNumber<Bits>>(search.findPrimes(1)[0]);
+        return function<long long(long long)>([=](long long iterations) {
+            long long primes = 0;
+            for (long long i = 0; i < iterations; i++) {
+                primes += prime->isPrime();  // All five rounds have to run
+            }
+            return primes;
+        });
+    }});
+}
+
+// Function to register the carry kernels at one length; items are limbs
+void addKernelBenchmarks(vector<Microbenchmark>& benchmarks, int length) {
+    string limbs = to_string(length);
+    // Function to build two random length-limb operands
+    auto operands = [length] {
+        auto a = make_shared<vector<uint64_t>>(length), b = make_shared<vector<uint64_t>>(length);
+        threadRandom().fill(a->data(), length);
+        threadRandom().fill(b->data(), length);
+        return make_pair(a, b);
+    };
+    benchmarks.push_back({"bignum/kernels/addLimbsInPlace/" + limbs, [=] {
+        auto [a, b] = operands();
+        return function<long long(long long)>([=](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                (*a)[0] += addLimbsInPlace(a->data(), length, b->data(), length);  // Keep the carry out inside the loop
+            }
+            return iterations * length;
+        });
+    }});
+    benchmarks.push_back({"bignum/kernels/limbsAtLeast/" + limbs, [=] {
+        auto [a, b] = operands();
+        (*b)[length - 1] = (*a)[length - 1];  // Equal top limbs, as near the end of a reduction
+        return function<long long(long long)>([=](long long iterations) {
+            long long atLeast = 0;
+            for (long long i = 0; i < iterations; i++) {
+                atLeast += limbsAtLeast(a->data(), b->data(), length);
+                (*a)[0] += atLeast;  // Keep the compare inside the loop
+            }
+            return iterations * length;
+        });
+    }});
+    benchmarks.push_back({"bignum/kernels/addLimbsBatch/" + limbs + "x1024", [=] {
+        const int count = 1024;
+        auto a = make_shared<vector<uint64_t>>(length * count), b = make_shared<vector<uint64_t>>(length * count);
+        auto carries = make_shared<vector<uint64_t>>(count);
+        threadRandom().fill(a->data(), length * count);
+        threadRandom().fill(b->data(), length * count);
+        return function<long long(long long)>([=](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                addLimbsBatch(a->data(), b->data(), length, count, carries->data());
+            }
+            return iterations * length * count;
+        });
+    }});
+}
+
+// Function to register scheduler admission and dispatch at one queue size
+void addSchedulerBenchmarks(vector<Microbenchmark>& benchmarks, int size) {
+    string queue = to_string(size);
+    // Function to build a workload of size processes that never finish within a benchmark
+    auto workload = [size] {
+        auto specs = make_shared<vector<ProcessSpec>>(size);
+        mt19937 random(1);
+        for (int i = 0; i < size; i++) {
+            (*specs)[i] = {i, 1000000000 + (int)(random() % 1000)};
+        }
+        return specs;
+    };
+    benchmarks.push_back({"scheduler/addProcess/" + queue, [=] {
+        auto specs = workload();
+        return function<long long(long long)>([=](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                ProcessScheduler scheduler;
+                for (const ProcessSpec& spec : *specs) {
+                    scheduler.addProcess(spec.process_id, spec.execution_time);
+                }
+            }
+            return iterations * size;
+        });
+    }});
+    benchmarks.push_back({"scheduler/addProcesses/" + queue, [=] {
+        auto specs = workload();
+        return function<long long(long long)>([=](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                ProcessScheduler scheduler;
+                scheduler.addProcesses(*specs);
+            }
+            return iterations * size;
+        });
+    }});
+    benchmarks.push_back({"scheduler/runCycle/" + queue, [=] {
+        auto specs = workload();
+        auto sink = make_shared<NullEventSink>();
+        auto scheduler = make_shared<ProcessScheduler>();
+        scheduler->setEventSink(*sink);
+        scheduler->addProcesses(*specs);
+        return function<long long(long long)>([=](long long iterations) {
+            int cycleCount = 1;
+            for (long long i = 0; i < iterations; i++) {
+                scheduler->runCycle(cycleCount);  // One dispatch per process
+            }
+            return iterations * size;
+        });
+    }});
+    benchmarks.push_back({"scheduler/ring/runCycle/" + queue, [=] {
+        auto specs = workload();
+        auto sink = make_shared<NullEventSink>();
+        auto scheduler = make_shared<RingProcessScheduler>();
+        scheduler->setEventSink(*sink);
+        scheduler->addProcesses(*specs);
+        return function<long long(long long)>([=](long long iterations) {
+            int cycleCount = 1;
+            for (long long i = 0; i < iterations; i++) {
+                scheduler->runCycle(cycleCount);
+            }
+            return iterations * size;
+        });
+    }});
+}
+
+// Function to build the full microbenchmark list
+vector<Microbenchmark> registerMicrobenchmarks() {
+    vector<Microbenchmark> benchmarks;
+    benchmarks.push_back({"bignum/list/1024/modMul", [] {
+        auto a = make_shared<LargeNumber>(), b = make_shared<LargeNumber>(), m = make_shared<LargeNumber>();
+        a->generateRandom();
+        b->generateRandom();
+        m->generateRandom();
+        return function<long long(long long)>([=](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                *a = a->modMul(*b, *m);
+            }
+            return iterations;
+        });
+    }});
+    benchmarks.push_back({"bignum/list/1024/modPow", [] {
+        auto base = make_shared<LargeNumber>(), m = make_shared<LargeNumber>();
+        auto exponent = make_shared<LargeNumber>(65537);  // Small exponent, as in runs from before the fixed-width delegation
+        base->generateRandom();
+        m->generateRandom();
+        return function<long long(long long)>([=](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                *base = base->modPow(*exponent, *m);
+            }
+            return iterations;
+        });
+    }});
+    addKernelBenchmarks(benchmarks, 16);
+    addKernelBenchmarks(benchmarks, 64);
+    addBignumBenchmarks<1024>(benchmarks);
+    addBignumBenchmarks<2048>(benchmarks);
+    addBignumBenchmarks<4096>(benchmarks);
+    for (int size : {1000, 100000, 1000000}) {
+        addSchedulerBenchmarks(benchmarks, size);
+    }
+    return benchmarks;
+}
+
+// Function to write results in the layout of Google Benchmark's JSON output
+void writeJson(ostream& out, const vector<MicrobenchmarkResult>& results) {
+#ifdef NDEBUG
+    const char* buildType = "release";
+#else
+    const char* buildType = "debug";
+#endif
+    out << "{\n  \"context\": {\n"
+        << "    \"num_cpus\": " << thread::hardware_concurrency() << ",\n"
+        << "    \"library_build_type\": \"" << buildType << "\",\n"
+        << "    \"seed\": 1\n  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const MicrobenchmarkResult& result = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+            << ", \"real_time\": " << result.nanosPerIteration << ", \"time_unit\": \"ns\", \"items_per_second\": "
+            << result.itemsPerSecond << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+// Function to run the reports that print their own results; returns the exit code
+int runReports() {
+    seedThreadRandom(1);  // Reproducible inputs across runs
+    benchmarkRandomSources();
+    benchmarkStorageBackends();
+    benchmarkCarryKernels();
+    benchmarkKaratsubaCrossover();
+    benchmarkReduction();
+    benchmarkMontgomery();
+    benchmarkWindowedExponentiation();
+    benchmarkParallelPrimality();
+    benchmarkPrimalityBatch();
+    benchmarkPrimeSearch();
+    benchmarkProcessChurn();
+    benchmarkAdmission();
+    benchmarkMultiCore();
+    benchmarkFastForward();
+    benchmarkPolicies();
+    benchmarkTraceReplay();
+    benchmarkEventSinks();
+    benchmarkSchedulerMetrics();
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    string filter, jsonPath;
+    double minSeconds = 0.2;
+    bool list = false;
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        if (argument == "--reports") {
+            return runReports();
+        } else if (argument == "--replay" && i + 1 < argc) {
+            return replayTraceReport(argv[i + 1]);
+        } else if (argument == "--list") {
+            list = true;
+        } else if (argument.rfind("--filter=", 0) == 0) {
+            filter = argument.substr(9);
+        } else if (argument.rfind("--json=", 0) == 0) {
+            jsonPath = argument.substr(7);
+        } else if (argument.rfind("--min-time=", 0) == 0) {
+            minSeconds = atof(argument.c_str() + 11);
+        } else {
+            cout << "Unknown argument " << argument << endl;
+            return 1;
+        }
+    }
+
+    vector<MicrobenchmarkResult> results;
+    for (const Microbenchmark& benchmark : registerMicrobenchmarks()) {
+        if (benchmark.name.find(filter) == string::npos) continue;
+        if (list) {
+            cout << benchmark.name << endl;
+            continue;
+        }
+        MicrobenchmarkResult result = runMicrobenchmark(benchmark, minSeconds);
+        cout << result.name << ": " << result.nanosPerIteration << " ns/iteration, " << result.itemsPerSecond
+             << " items/s (" << result.iterations << " iterations)" << endl;
+        results.push_back(result);
+    }
+
+    if (!jsonPath.empty()) {
+        ofstream json(jsonPath);
+        if (!json) {
+            cout << "Could not write " << jsonPath << endl;
+            return 1;
+        }
+        writeJson(json, results);
+    }
+    return 0;
+}
@@ -0,0 +1,265 @@
+// Out-of-line definitions for LargeNumber.h
+#include "LargeNumber.h"
+using namespace std;
+
+// Seed shared by the per-thread generators, and a generation counter so existing
+// threads pick up a new seed. Everything here but the functions declared in
+// LargeNumber.h is internal to this file.
+static atomic<uint64_t> random_seed(0);
+static atomic<uint64_t> random_seed_generation(0);
+static atomic<uint64_t> random_thread_count(0);
+
+// Stream value of a thread that has not been given one
+static const uint64_t no_random_stream = UINT64_MAX;
+// The calling thread's stream, and the seed generation its generator was last built from
+static thread_local uint64_t thread_random_stream = no_random_stream;
+static thread_local uint64_t thread_random_generation = 0;
+
+// Make every thread's generator deterministic: a thread with a stream draws from seed
+// mixed with that stream, any other from seed mixed with the order it first asks in
+void seedThreadRandom(uint64_t seed) {
+    random_seed = seed;
+    random_thread_count = 0;
+    random_seed_generation++;
+}
+
+// Give the calling thread its own stream; the generator is rebuilt on the next draw
+void setThreadRandomStream(uint64_t stream) {
+    thread_random_stream = stream;
+    thread_random_generation = 0; // Differs from every seed generation once one is set
+}
+
+// The calling thread's own fast generator. No lock is taken; each thread has its own
+// state, seeded from std::random_device until seedThreadRandom is called.
+Xoshiro256StarStar& threadRandom() {
+    thread_local Xoshiro256StarStar generator(random_device{}() ^ ((uint64_t)random_device{}() << 32));
+    uint64_t current = random_seed_generation.load(memory_order_acquire);
+    if (thread_random_generation != current) {
+        thread_random_generation = current;
+        // Odd keys for numbered streams and even keys for threads counted by first use
+        uint64_t key = thread_random_stream != no_random_stream ? 2 * thread_random_stream + 1
+                                                                 : 2 * random_thread_count++;
+        generator.reseed(random_seed.load() ^ (key * 0x9E3779B97F4A7C15ULL));
+    }
+    return generator;
+}
+
+// The first count odd primes (3, 5, 7, ...), computed once with a sieve of Eratosthenes
+const vector<uint32_t>& smallOddPrimes(int count) {
+    static mutex tableLock;
+    static map<int, vector<uint32_t>> tables;
+    lock_guard<mutex> guard(tableLock);
+    vector<uint32_t>& primes = tables[count];
+    if (!primes.empty()) return primes;
+
+    int limit = 64;
+    while ((int)primes.size() < count) {
+        limit *= 2; // Grow the sieve until it holds enough primes
+        vector<bool> composite(limit, false);
+        primes.clear();
+        for (int i = 3; i < limit && (int)primes.size() < count; i += 2) {
+            if (composite[i]) continue;
+            primes.push_back(i);
+            for (long long j = (long long)i * i; j < limit; j += 2 * i) composite[j] = true;
+        }
+    }
+    return primes;
+}
+
+// Operand size in limbs from which multiplyKaratsuba splits instead of using schoolbook.
+// Tune it with the crossover benchmark; values below 4 are treated as 4.
+int karatsuba_threshold = 24;
+
+// Limb arrays reused by the list LargeNumber arithmetic on each thread. They only grow,
+// so after warm-up mod and modMul make no heap allocations.
+namespace {
+struct ListScratch {
+    vector<uint64_t> a, b; // Operands copied out of the lists
+    vector<uint64_t> product; // Full product before reduction
+    vector<uint64_t> remainder; // Result of the division
+    vector<uint64_t> division; // Scratch for divideLimbs and multiplyKaratsuba
+};
+}
+
+static ListScratch& listScratch() {
+    thread_local ListScratch scratch;
+    return scratch;
+}
+
+// Function to multiply two list numbers into scratch.product, returning its length in limbs.
+// Equal lengths go through multiplyKaratsuba (squaring when both are the same number).
+static int multiplyLists(ListScratch& scratch, const LargeNumber& a, const LargeNumber& b) {
+    int aLength = a.nodeCount(), bLength = b.nodeCount();
+    scratch.a.resize(aLength);
+    scratch.b.resize(bLength);
+    scratch.product.resize(aLength + bLength);
+    a.copyLimbs(scratch.a.data(), aLength);
+    b.copyLimbs(scratch.b.data(), bLength);
+    if (aLength == bLength && aLength > 0) {
+        scratch.division.resize(karatsubaScratchLimbs(aLength) + 1);
+        const uint64_t* second = &a == &b ? scratch.a.data() : scratch.b.data();
+        multiplyKaratsuba(scratch.a.data(), second, aLength, scratch.product.data(), scratch.division.data());
+    } else {
+        multiplyLimbs(scratch.a.data(), aLength, scratch.b.data(), bLength, scratch.product.data());
+    }
+    return aLength + bLength;
+}
+
+// Reduce this number modulo m in place with one long division
+LargeNumber& LargeNumber::operator%=(const LargeNumber& m) {
+    if (m.isZero()) return *this; // Nothing to reduce by
+    ListScratch& scratch = listScratch();
+    int length = nodeCount(), modulusLength = m.nodeCount();
+    scratch.a.resize(length);
+    scratch.b.resize(modulusLength);
+    scratch.remainder.resize(modulusLength);
+    scratch.division.resize(length + modulusLength + 1);
+    copyLimbs(scratch.a.data(), length);
+    m.copyLimbs(scratch.b.data(), modulusLength);
+    divideLimbs(scratch.a.data(), length, scratch.b.data(), modulusLength, nullptr, scratch.remainder.data(),
+                scratch.division.data());
+    assignLimbs(scratch.remainder.data(), modulusLength);
+    return *this;
+}
+
+// Modular multiplication: product of the limbs, then one long division by m
+LargeNumber LargeNumber::modMul(const LargeNumber& other, const LargeNumber& m) const {
+    if (m.isZero()) return LargeNumber(0); // No residue to give
+    ListScratch& scratch = listScratch();
+    int productLength = multiplyLists(scratch, *this, other);
+    int modulusLength = m.nodeCount();
+    scratch.b.resize(modulusLength); // The operands are no longer needed, reuse b for m
+    scratch.remainder.resize(modulusLength);
+    scratch.division.resize(productLength + modulusLength + 1);
+    m.copyLimbs(scratch.b.data(), modulusLength);
+    divideLimbs(scratch.product.data(), productLength, scratch.b.data(), modulusLength, nullptr,
+                scratch.remainder.data(), scratch.division.data());
+    LargeNumber result;
+    result.assignLimbs(scratch.remainder.data(), modulusLength);
+    return result;
+}
+
+// In-place multiplication keeping the full product
+LargeNumber& LargeNumber::operator*=(const LargeNumber& other) {
+    ListScratch& scratch = listScratch();
+    int productLength = multiplyLists(scratch, *this, other);
+    assignLimbs(scratch.product.data(), productLength);
+    return *this;
+}
+
+// Function to copy a list number into a FixedLargeNumber; nodes beyond the width are dropped
+template <int Bits>
+static FixedLargeNumber<Bits> toFixedWidth(const LargeNumber& number) {
+    uint64_t limbs[FixedLargeNumber<Bits>::limb_count];
+    number.copyLimbs(limbs, FixedLargeNumber<Bits>::limb_count);
+    FixedLargeNumber<Bits> fixed;
+    for (int i = 0; i < FixedLargeNumber<Bits>::limb_count; ++i) fixed.setLimb(i, limbs[i]);
+    return fixed;
+}
+
+// Function to copy a FixedLargeNumber back into a list number
+template <int Bits>
+static LargeNumber fromFixedWidth(const FixedLargeNumber<Bits>& fixed) {
+    uint64_t limbs[FixedLargeNumber<Bits>::limb_count];
+    for (int i = 0; i < FixedLargeNumber<Bits>::limb_count; ++i) limbs[i] = fixed.limb(i);
+    LargeNumber number;
+    number.assignLimbs(limbs, FixedLargeNumber<Bits>::limb_count);
+    return number;
+}
+
+// base^exponent mod m at one fixed width, for list operands that fit in it
+template <int Bits>
+static LargeNumber modPowAt(const LargeNumber& base, const LargeNumber& exponent, const LargeNumber& m) {
+    return fromFixedWidth(toFixedWidth<Bits>(base).modPow(toFixedWidth<Bits>(exponent), toFixedWidth<Bits>(m)));
+}
+
+// Modular exponentiation, on the narrowest fixed width that holds the operands
+LargeNumber LargeNumber::modPow(const LargeNumber& exponent, const LargeNumber& m) const {
+    if (m.isZero() || m.isOne()) return LargeNumber(0); // No residue, or everything is zero mod one
+    LargeNumber base = this->mod(m); // Reduce base with modulus, so it is no wider than m
+    int length = max(m.nodeCount(), exponent.nodeCount()); // Nodes the fixed width must hold
+    if (length <= 1024 / 64) return modPowAt<1024>(base, exponent, m);
+    if (length <= 2048 / 64) return modPowAt<2048>(base, exponent, m);
+    if (length <= 4096 / 64) return modPowAt<4096>(base, exponent, m);
+
+    LargeNumber result(1); // Initialize result to 1
+    LargeNumber exp = exponent; // Copy exponent
+    while (!exp.isZero()) { // While exponent is not zero
+        if (!exp.isEven()) {
+            result = result.modMul(base, m); // Multiply result with base and take modulus
+        }
+        base = base.modMul(base, m); // Square base and take modulus
+        exp.divideByTwo(); // Divide exponent by two
+    }
+    return result;
+}
+
+// Miller-Rabin with 5 rounds, on the narrowest fixed width that holds the number
+bool LargeNumber::isPrime() const {
+    int length = nodeCount();
+    if (length <= 1024 / 64) return toFixedWidth<1024>(*this).isPrime();
+    if (length <= 2048 / 64) return toFixedWidth<2048>(*this).isPrime();
+    if (length <= 4096 / 64) return toFixedWidth<4096>(*this).isPrime();
+    if (isEven()) return false; // Exclude even numbers
+
+    LargeNumber one(1);
+    LargeNumber nMinusOne = *this - one; // n - 1, computed once
+
+    LargeNumber d = nMinusOne; // d = n - 1
+    int s = 0; // Count of factors of 2 in d
+    while (d.isEven()) {
+        d.divideByTwo(); // Divide d by 2
+        s++; // Increase count of factors of 2
+    }
+    for (int i = 0; i < 5; i++) { // 5 iterations for Miller-Rabin
+        LargeNumber a;
+        a.generateRandom(); // Generate random number
+        a = a.mod(*this); // Reduce it modulo n
+
+        if (a.isZero() || a.isOne()) continue; // Skip if a is 0 or 1
+
+        LargeNumber x = a.modPow(d, *this); // x = a^d mod n
+
+        if (x.isOne() || x == nMinusOne) continue; // x is either 1 or n - 1
+
+        bool composite = true; // Assume number is composite
+        for (int j = 0; j < s - 1; j++) {
+            x = x.modMul(x, *this); // Square x and take modulus
+            if (x == nMinusOne) { // Check if x is n - 1
+                composite = false; // Found a witness, it's not composite
+                break;
+            }
+        }
+        if (composite) return false; // If still composite, n is not prime
+    }
+    return true; // n is probably prime
+}
+
+// Function to batch-test the candidates at the given indices as FixedLargeNumber<Bits>
+// copies, writing each verdict back to its index
+template <int Bits>
+static void isPrimeBatchAt(span<const LargeNumber> candidates, const vector<size_t>& indices, int rounds,
+                           vector<bool>& verdicts) {
+    if (indices.empty()) return;
+    vector<FixedLargeNumber<Bits>> numbers(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) numbers[i] = toFixedWidth<Bits>(candidates[indices[i]]);
+    vector<bool> batch = isPrimeBatch<Bits>(numbers, rounds);
+    for (size_t i = 0; i < indices.size(); ++i) verdicts[indices[i]] = batch[i];
+}
+
+// isPrimeBatch for list numbers, on the narrowest fixed width that holds each candidate
+vector<bool> isPrimeBatch(span<const LargeNumber> candidates, int rounds) {
+    vector<bool> verdicts(candidates.size());
+    vector<size_t> at1024, at2048, at4096; // Candidate indices by width
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        int length = candidates[i].nodeCount();
+        if (length <= 1024 / 64) at1024.push_back(i);
+        else if (length <= 2048 / 64) at2048.push_back(i);
+        else if (length <= 4096 / 64) at4096.push_back(i);
+        else verdicts[i] = candidates[i].isPrime(); // Too wide for any batch
+    }
+    isPrimeBatchAt<1024>(candidates, at1024, rounds, verdicts);
+    isPrimeBatchAt<2048>(candidates, at2048, rounds, verdicts);
+    isPrimeBatchAt<4096>(candidates, at4096, rounds, verdicts);
+    return verdicts;
+}
@@ -0,0 +1,2247 @@
+// Large-number arithmetic for assignment 1, question 2: the linked-list LargeNumber,
+// fixed-width numbers, Montgomery and Barrett reduction, and prime search
+#pragma once
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+#include <cstring>
+#include <climits>
+#include <cstdint>
+#include <random>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <span>
+#include <algorithm>
+#include <deque>
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define LARGE_NUMBER_X86 1
+#endif
+
+using namespace std;
+
+// Constants defining node and bit sizes
+const int bits_per_node = 64; // Each node can hold 64 bits (uint64_t)
+const int nodes_required = 1024 / bits_per_node; // Total nodes required to represent a 1024-bit number
+const uint64_t MAX_UINT64 = UINT64_MAX; // Maximum value for a 64-bit unsigned integer
+
+// Node structure representing each part of a large number
+struct Node {
+    uint64_t value; // Value stored in the node
+    Node* next; // Pointer to the next node in the linked list
+    Node(uint64_t val = 0) : value(val), next(nullptr) {} // Constructor initializing node value
+
+    // Nodes are carved from the calling thread's NodeArena instead of the heap
+    static void* operator new(size_t size);
+    static void operator delete(void* memory);
+};
+
+// Per-thread free list of Node-sized blocks, filled from slabs of node_arena_slab_size
+// nodes. Deleted nodes go back on the free list, so once the arena has grown to the peak
+// number of live nodes, LargeNumber arithmetic no longer touches the heap. Slabs are
+// kept for the life of the process because a node may be freed on another thread, but
+// when a thread exits its free blocks move to a shared list, which arenas empty before
+// taking a new slab, so short-lived worker threads do not strand their nodes.
+const int node_arena_slab_size = 256; // Nodes per slab
+
+class NodeArena {
+private:
+    struct FreeBlock {
+        FreeBlock* next; // Next free block
+    };
+    FreeBlock* freeList; // Blocks ready for reuse
+    long long slabs; // Slabs taken from the heap so far
+    inline static mutex sharedLock; // Guards sharedList
+    inline static FreeBlock* sharedList = nullptr; // Blocks left behind by exited threads
+
+    NodeArena() : freeList(nullptr), slabs(0) {}
+    // Destructor, run when the thread exits: hand the free blocks to the shared list
+    ~NodeArena() {
+        if (!freeList) return;
+        FreeBlock* last = freeList;
+        while (last->next) last = last->next;
+        lock_guard<mutex> guard(sharedLock);
+        last->next = sharedList;
+        sharedList = freeList;
+        freeList = nullptr;
+    }
+public:
+    // The calling thread's arena
+    static NodeArena& local() {
+        thread_local NodeArena arena;
+        return arena;
+    }
+    // Hand out one node-sized block, taking the shared list or growing by a slab when the
+    // free list is empty
+    void* allocate() {
+        if (!freeList) {
+            lock_guard<mutex> guard(sharedLock);
+            freeList = sharedList; // Everything exited threads left behind
+            sharedList = nullptr;
+        }
+        if (!freeList) {
+            char* slab = static_cast<char*>(::operator new(sizeof(Node) * node_arena_slab_size));
+            for (int i = node_arena_slab_size - 1; i >= 0; --i) {
+                FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + i * sizeof(Node));
+                block->next = freeList;
+                freeList = block;
+            }
+            slabs++;
+        }
+        FreeBlock* block = freeList;
+        freeList = block->next;
+        return block;
+    }
+    // Return a block to the free list
+    void release(void* memory) {
+        FreeBlock* block = static_cast<FreeBlock*>(memory);
+        block->next = freeList;
+        freeList = block;
+    }
+    // Slabs this arena has taken from the heap
+    long long slabCount() const {
+        return slabs;
+    }
+};
+
+inline void* Node::operator new(size_t) {
+    return NodeArena::local().allocate();
+}
+
+inline void Node::operator delete(void* memory) {
+    NodeArena::local().release(memory);
+}
+
+// Source of random 64-bit limbs. Generators fill whole limb arrays at a time so
+// that one virtual call covers a full number.
+class RandomSource {
+public:
+    virtual ~RandomSource() {}
+    // Fill count limbs with random bits
+    virtual void fill(uint64_t* limbs, int count) = 0;
+};
+
+// SplitMix64, used to expand a single seed into generator state
+class SplitMix64 {
+private:
+    uint64_t state; // Weyl sequence state
+public:
+    SplitMix64(uint64_t seed) : state(seed) {}
+    // Next 64-bit output
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+// xoshiro256** fast non-cryptographic generator, for Miller-Rabin witnesses and benchmarks
+class Xoshiro256StarStar : public RandomSource {
+private:
+    uint64_t state[4]; // Generator state, never all zero
+
+    static uint64_t rotateLeft(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+public:
+    // Constructor expanding the seed with SplitMix64
+    Xoshiro256StarStar(uint64_t seed) {
+        reseed(seed);
+    }
+    // Restart the sequence from a new seed
+    void reseed(uint64_t seed) {
+        SplitMix64 expander(seed);
+        for (int i = 0; i < 4; ++i) state[i] = expander.next();
+    }
+    // Next 64-bit output
+    uint64_t next() {
+        uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotateLeft(state[3], 45);
+        return result;
+    }
+    void fill(uint64_t* limbs, int count) override {
+        for (int i = 0; i < count; ++i) limbs[i] = next();
+    }
+};
+
+// ChaCha20-based cryptographically secure generator, for key material.
+// The key comes from std::random_device unless an explicit seed is given.
+class ChaCha20Random : public RandomSource {
+private:
+    uint32_t key[8]; // 256-bit key
+    uint64_t counter; // Block counter
+    uint32_t block[16]; // Current keystream block
+    int used; // 32-bit words of block already handed out
+
+    static uint32_t rotateLeft(uint32_t x, int k) {
+        return (x << k) | (x >> (32 - k));
+    }
+    static void quarterRound(uint32_t* x, int a, int b, int c, int d) {
+        x[a] += x[b]; x[d] = rotateLeft(x[d] ^ x[a], 16);
+        x[c] += x[d]; x[b] = rotateLeft(x[b] ^ x[c], 12);
+        x[a] += x[b]; x[d] = rotateLeft(x[d] ^ x[a], 8);
+        x[c] += x[d]; x[b] = rotateLeft(x[b] ^ x[c], 7);
+    }
+    // Produce the next 64-byte keystream block
+    void refill() {
+        uint32_t input[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574, // "expand 32-byte k"
+                              key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+                              (uint32_t)counter, (uint32_t)(counter >> 32), 0, 0};
+        for (int i = 0; i < 16; ++i) block[i] = input[i];
+        for (int round = 0; round < 10; ++round) { // 20 rounds as 10 column/diagonal pairs
+            quarterRound(block, 0, 4, 8, 12);
+            quarterRound(block, 1, 5, 9, 13);
+            quarterRound(block, 2, 6, 10, 14);
+            quarterRound(block, 3, 7, 11, 15);
+            quarterRound(block, 0, 5, 10, 15);
+            quarterRound(block, 1, 6, 11, 12);
+            quarterRound(block, 2, 7, 8, 13);
+            quarterRound(block, 3, 4, 9, 14);
+        }
+        for (int i = 0; i < 16; ++i) block[i] += input[i];
+        counter++;
+        used = 0;
+    }
+public:
+    // Constructor keyed from the operating system entropy source
+    ChaCha20Random() : counter(0), used(16) {
+        random_device entropy;
+        for (int i = 0; i < 8; ++i) key[i] = entropy();
+    }
+    // Constructor with a deterministic key expanded from seed, for reproducible runs
+    ChaCha20Random(uint64_t seed) : counter(0), used(16) {
+        SplitMix64 expander(seed);
+        for (int i = 0; i < 8; i += 2) {
+            uint64_t word = expander.next();
+            key[i] = (uint32_t)word;
+            key[i + 1] = (uint32_t)(word >> 32);
+        }
+    }
+    void fill(uint64_t* limbs, int count) override {
+        for (int i = 0; i < count; ++i) {
+            if (used > 14) refill();
+            limbs[i] = block[used] | ((uint64_t)block[used + 1] << 32);
+            used += 2;
+        }
+    }
+};
+
+// Make every thread's generator deterministic: a thread given a stream with
+// setThreadRandomStream draws from seed mixed with that stream, and any other thread from
+// seed mixed with k, where k counts such threads in the order they first ask for numbers
+void seedThreadRandom(uint64_t seed);
+
+// Give the calling thread its own numbered stream, so that after seedThreadRandom it draws
+// the same numbers whatever order threads start in. The generator restarts from the start
+// of the stream on its next draw. Before any seedThreadRandom call this has no effect.
+void setThreadRandomStream(uint64_t stream);
+
+// The calling thread's own fast generator. No lock is taken; each thread has its own
+// state, seeded from std::random_device until seedThreadRandom is called.
+Xoshiro256StarStar& threadRandom();
+
+// Add-with-carry on one limb: returns a + b + carryIn and sets carryOut to the carry (0 or 1).
+// On x86-64 this is a single ADC, so carry chains built from it have no branches; elsewhere
+// the same arithmetic goes through unsigned __int128.
+inline uint64_t addCarry(uint64_t a, uint64_t b, unsigned char carryIn, unsigned char& carryOut) {
+#ifdef LARGE_NUMBER_X86
+    unsigned long long sum;
+    carryOut = _addcarry_u64(carryIn, a, b, &sum);
+    return sum;
+#else
+    unsigned __int128 sum = (unsigned __int128)a + b + carryIn;
+    carryOut = (unsigned char)(sum >> 64);
+    return (uint64_t)sum;
+#endif
+}
+
+// Subtract-with-borrow on one limb: returns a - b - borrowIn and sets borrowOut (0 or 1)
+inline uint64_t subtractBorrow(uint64_t a, uint64_t b, unsigned char borrowIn, unsigned char& borrowOut) {
+#ifdef LARGE_NUMBER_X86
+    unsigned long long difference;
+    borrowOut = _subborrow_u64(borrowIn, a, b, &difference);
+    return difference;
+#else
+    unsigned __int128 difference = (unsigned __int128)a - b - borrowIn;
+    borrowOut = (unsigned char)(difference >> 127);
+    return (uint64_t)difference;
+#endif
+}
+
+class LargeNumber {
+private:
+    Node* head; 
+
+    // function to perform a deep copy of another LargeNumber
+    void deepCopy(const LargeNumber& other) {
+        Node* otherCurrent = other.head; // Pointer to traverse the other LargeNumber
+        Node** current = &head; // Pointer to insert new nodes into this LargeNumber
+        while (otherCurrent) {
+            *current = new Node(otherCurrent->value); // Create a new node and copy the value
+            current = &((*current)->next); // Move to the next pointer
+            otherCurrent = otherCurrent->next; // Move to the next node in the other LargeNumber
+        }
+    }
+    // Free every node of this number
+    void clear() {
+        while (head) {
+            Node* temp = head; // Pointer to the current head
+            head = head->next; // Move head to the next node
+            delete temp; // Delete the old head
+        }
+    }
+    // Remove zero nodes above the most significant nonzero node, keeping at least one node
+    void trimLeadingZeros() {
+        Node* last = head; // Most significant nonzero node so far
+        for (Node* current = head; current; current = current->next) {
+            if (current->value != 0) last = current;
+        }
+        if (!last) return; // Empty number
+        Node* current = last->next;
+        last->next = nullptr; // Cut the zero nodes off
+        while (current) {
+            Node* temp = current;
+            current = current->next; // Move to the next node
+            delete temp; // Delete the zero node
+        }
+    }
+public:
+    // Default constructor
+    LargeNumber() : head(nullptr) {}
+
+    // Constructor to initialize with a single uint64_t value
+    LargeNumber(uint64_t val) : head(nullptr) {
+        head = new Node(val); // Create a new node for the value
+    }
+    // Copy constructor
+    LargeNumber(const LargeNumber& other) : head(nullptr) {
+        deepCopy(other); // Call deepCopy to copy nodes
+    }
+    // Move constructor, takes over the other number's nodes
+    LargeNumber(LargeNumber&& other) noexcept : head(other.head) {
+        other.head = nullptr;
+    }
+    // Assignment operator
+    LargeNumber& operator=(const LargeNumber& other) {
+        if (this != &other) { // Self-assignment check
+            clear(); // Deallocate existing nodes
+            deepCopy(other); // Deep copy the new nodes
+        }
+        return *this; // Return current object
+    }
+    // Move assignment operator, takes over the other number's nodes
+    LargeNumber& operator=(LargeNumber&& other) noexcept {
+        if (this != &other) { // Self-assignment check
+            clear(); // Deallocate existing nodes
+            head = other.head;
+            other.head = nullptr;
+        }
+        return *this; // Return current object
+    }
+    // Generate a random 1024-bit number from the calling thread's generator
+    void generateRandom() {
+        generateRandom(threadRandom());
+    }
+    // Generate a random 1024-bit number from the given source
+    void generateRandom(RandomSource& source) {
+        uint64_t randomValues[nodes_required];
+        source.fill(randomValues, nodes_required); // One call for every limb
+        clear(); // Replace any previous value
+        Node** current = &head; // Link to append the next node at
+        for (int i = 0; i < nodes_required; ++i) {
+            uint64_t randomValue = randomValues[i];
+            if (i == nodes_required - 1) {
+                randomValue |= (1ULL << 63); // Ensure the last node is set to 1024 bits
+            }
+            *current = new Node(randomValue); // Nodes go least significant first
+            current = &((*current)->next); // Move to the next pointer
+        }
+    }
+    // Number of nodes in the list
+    int nodeCount() const {
+        int count = 0;
+        for (Node* current = head; current; current = current->next) count++;
+        return count;
+    }
+    // Replace the value with count limbs, least significant first, reusing this number's
+    // nodes; zero limbs at the top are dropped
+    void assignLimbs(const uint64_t* limbs, int count) {
+        Node** current = &head; // Link to the node being overwritten
+        for (int i = 0; i < count; ++i) {
+            if (!*current) *current = new Node(0); // Grow when this number is shorter
+            (*current)->value = limbs[i];
+            current = &((*current)->next); // Move to the next pointer
+        }
+        Node* rest = *current; // Nodes beyond count are no longer needed
+        *current = nullptr;
+        while (rest) {
+            Node* temp = rest;
+            rest = rest->next; // Move to the next node
+            delete temp; // Delete the unused node
+        }
+        trimLeadingZeros();
+    }
+    // Copy the lowest count nodes into limbs, least significant first, padding with zeros
+    void copyLimbs(uint64_t* limbs, int count) const {
+        Node* current = head; // Pointer to traverse the linked list
+        for (int i = 0; i < count; ++i) {
+            limbs[i] = current ? current->value : 0;
+            if (current) current = current->next; // Move to the next node
+        }
+    }
+    // Check if the number is even
+    bool isEven() const {
+        return head && !(head->value & 1); // Check if the least significant bit is 0
+    }
+    // Check if the number is zero
+    bool isZero() const {
+        Node* current = head; // Pointer to traverse the linked list
+        while (current) {
+            if (current->value != 0) return false; // Return false if any value is not zero
+            current = current->next; // Move to the next node
+        }
+        return true; // All values are zero
+    }
+    // Check if the number is one
+    bool isOne() const {
+        if (!head || head->value != 1) return false; // Check if the head is 1
+        Node* current = head->next; // Pointer to traverse remaining nodes
+        while (current) {
+            if (current->value != 0) return false; // Return false if any subsequent value is not zero
+            current = current->next; // Move to the next node
+        }
+        return true; // The number is one
+    }
+    // Divide the large number by two
+    void divideByTwo() {
+        Node* current = head; // Pointer to traverse the linked list, least significant first
+        while (current) {
+            uint64_t highBit = current->next ? current->next->value << 63 : 0; // Bit shifted down from the next node
+            current->value = (current->value >> 1) | highBit; // Shift right and bring in that bit
+            current = current->next; // Move to the next node
+        }
+        trimLeadingZeros(); // The top node may have become zero
+    }
+    // Subtract another LargeNumber from this one
+    void subtract(const LargeNumber& other) {
+        Node* thisCurrent = head; // Pointer for this number
+        Node* otherCurrent = other.head; // Pointer for other number
+        unsigned char borrow = 0; // Borrow for subtraction
+        // Loop through both numbers
+        while (thisCurrent && otherCurrent) {
+            thisCurrent->value = subtractBorrow(thisCurrent->value, otherCurrent->value, borrow, borrow);
+            thisCurrent = thisCurrent->next; // Move to the next node
+            otherCurrent = otherCurrent->next; // Move to the next node
+        }
+        // Propagate the borrow through the remaining nodes in this number
+        while (thisCurrent && borrow) {
+            thisCurrent->value = subtractBorrow(thisCurrent->value, 0, borrow, borrow);
+            thisCurrent = thisCurrent->next; // Move to the next node
+        }
+        trimLeadingZeros(); // Remove leading zeros
+    }
+    // Reduce this number modulo m in place with one long division (Knuth's Algorithm D on
+    // the limbs); a zero modulus leaves the number unchanged
+    LargeNumber& operator%=(const LargeNumber& m);
+    // Calculate modulus of this number with another LargeNumber
+    LargeNumber mod(const LargeNumber& m) const {
+        LargeNumber result = *this; // Copy this number
+        result %= m; // Reduce the copy
+        return result; // Return the result
+    }
+    // Perform modular multiplication of this number with another LargeNumber: the full
+    // product is reduced with one long division
+    LargeNumber modMul(const LargeNumber& other, const LargeNumber& m) const;
+    // Perform modular exponentiation. Up to 4096 bits the operands are copied into the
+    // narrowest FixedLargeNumber that holds them and raised there (Montgomery for odd moduli,
+    // Barrett for even ones); wider numbers fall back to binary exponentiation with modMul.
+    // A zero modulus gives zero.
+    LargeNumber modPow(const LargeNumber& exponent, const LargeNumber& m) const;
+    // Comparison operator for equality
+    bool operator==(const LargeNumber& other) const {
+        Node* thisCurrent = head; // Pointer for this number
+        Node* otherCurrent = other.head; // Pointer for other number
+        // Compare node values
+        while (thisCurrent && otherCurrent) {
+            if (thisCurrent->value != otherCurrent->value) return false; // If values differ, return false
+            thisCurrent = thisCurrent->next; // Move to the next node
+            otherCurrent = otherCurrent->next; // Move to the next node
+        }
+        return !thisCurrent && !otherCurrent; // Return true if both lists are fully traversed
+    }
+    // Comparison operator for greater than or equal to
+    bool operator>=(const LargeNumber& other) const {
+        Node* thisCurrent = head; // Pointer for this number
+        Node* otherCurrent = other.head; // Pointer for other number
+        // One lockstep pass running the borrow chain of this - other, a missing node counting
+        // as zero: this >= other exactly when nothing is borrowed out of the top
+        unsigned char borrow = 0; // Borrow for the subtraction
+        while (thisCurrent || otherCurrent) {
+            uint64_t thisValue = thisCurrent ? thisCurrent->value : 0;
+            uint64_t otherValue = otherCurrent ? otherCurrent->value : 0;
+            subtractBorrow(thisValue, otherValue, borrow, borrow); // Only the borrow is kept
+            if (thisCurrent) thisCurrent = thisCurrent->next; // Move to the next node
+            if (otherCurrent) otherCurrent = otherCurrent->next; // Move to the next node
+        }
+        return !borrow;
+    }
+    // In-place addition, reusing this number's nodes (other may be this number)
+    LargeNumber& operator+=(const LargeNumber& other) {
+        Node** thisCurrent = &head; // Link to the node being updated
+        Node* otherCurrent = other.head; // Pointer for other number
+        unsigned char carry = 0; // Carry for addition
+        // Loop until the other number and the carry are used up
+        while (otherCurrent || carry) {
+            if (!*thisCurrent) {
+                *thisCurrent = new Node(0); // Grow this number when it is the shorter one
+            }
+            uint64_t addend = 0; // Value from the other number, 0 once it runs out
+            if (otherCurrent) {
+                addend = otherCurrent->value;
+                otherCurrent = otherCurrent->next; // Move to the next node
+            }
+            (*thisCurrent)->value = addCarry((*thisCurrent)->value, addend, carry, carry); // Sum in place, carry out
+            thisCurrent = &((*thisCurrent)->next); // Move to the next pointer
+        }
+        return *this;
+    }
+    // In-place subtraction
+    LargeNumber& operator-=(const LargeNumber& other) {
+        subtract(other);
+        return *this;
+    }
+    // In-place multiplication keeping the full product, reusing this number's nodes
+    // (other may be this number)
+    LargeNumber& operator*=(const LargeNumber& other);
+    // In-place right shift by the given number of bits: whole nodes are dropped from the
+    // bottom, then one pass shifts the rest by the remaining bits
+    LargeNumber& operator>>=(int bits) {
+        if (bits <= 0 || !head) return *this;
+        for (int i = bits / bits_per_node; i > 0 && head; --i) {
+            Node* temp = head; // Lowest node, shifted out entirely
+            head = head->next;
+            delete temp;
+        }
+        if (!head) { // Every bit was shifted out
+            head = new Node(0);
+            return *this;
+        }
+        int shift = bits % bits_per_node;
+        if (shift > 0) {
+            for (Node* current = head; current; current = current->next) {
+                uint64_t highBits = current->next ? current->next->value << (bits_per_node - shift) : 0; // From the next node
+                current->value = (current->value >> shift) | highBits;
+            }
+        }
+        trimLeadingZeros(); // The top node may have become zero
+        return *this;
+    }
+    // Addition operator
+    LargeNumber operator+(const LargeNumber& other) const {
+        LargeNumber result = *this; // Copy this number
+        result += other; // Add other to the copy
+        return result; 
+    }
+    // Subtraction operator
+    LargeNumber operator-(const LargeNumber& other) const {
+        LargeNumber result = *this; // Copy this number
+        result.subtract(other); // Subtract other from the copy
+        return result; // Return the result
+    }
+    // Check if the number is prime using Miller-Rabin primality test with 5 rounds. Up to
+    // 4096 bits this is FixedLargeNumber::isPrime on a copy of the limbs; wider numbers run
+    // the rounds on the list itself.
+    bool isPrime() const;
+    // Display the number
+    void display() const {
+        Node* current = head; // Pointer to traverse the linked list
+        while (current) {
+            cout << current->value << " "; // Print each node value
+            current = current->next; // Move to the next node
+        }
+        cout << endl; 
+    }
+    // Destructor to clean up memory
+    ~LargeNumber() {
+        clear();
+    }
+};
+// Fixed set of worker threads that all run the same job, used to spread
+// independent pieces of work (witness rounds, candidate batches) across cores.
+class WorkerPool {
+private:
+    vector<thread> workers; // The worker threads
+    mutex runLock; // Held by run() for a whole job, so callers on other threads take turns
+    mutex lock; // Guards every field below
+    condition_variable wake; // Signals workers that a new job is ready
+    condition_variable finished; // Signals run() that every worker is done
+    function<void(int)> job; // Current job, called with the worker index
+    int generation; // Incremented for every job so workers run it exactly once
+    int running; // Workers still busy with the current job
+    bool stopping; // Set by the destructor
+    uint64_t randomStreams; // First random stream of this pool's workers
+    inline static atomic<uint64_t> pools_created{0}; // Pools so far, numbering their random streams
+
+    // Body of each worker thread
+    void workerLoop(int index) {
+        setThreadRandomStream(randomStreams + index); // Fixed by pool and index, not by start order
+        int seen = 0; // Last generation this worker ran
+        while (true) {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            guard.unlock();
+            job(index); // Run outside the lock
+            guard.lock();
+            if (--running == 0) finished.notify_one();
+        }
+    }
+public:
+    // Constructor starting the given number of worker threads
+    WorkerPool(int threads) : generation(0), running(0), stopping(false), randomStreams(++pools_created << 32) {
+        if (threads < 1) threads = 1;
+        for (int i = 0; i < threads; ++i) {
+            workers.emplace_back(&WorkerPool::workerLoop, this, i);
+        }
+    }
+    // Number of worker threads
+    int size() const {
+        return (int)workers.size();
+    }
+    // Run job(workerIndex) once on every worker and wait for all of them to return.
+    // Safe to call from several threads at once; the jobs then run one after another.
+    // A job must not call run() on the pool that is running it.
+    void run(const function<void(int)>& newJob) {
+        lock_guard<mutex> turn(runLock); // One job at a time owns job, running and generation
+        unique_lock<mutex> guard(lock);
+        job = newJob;
+        running = (int)workers.size();
+        generation++;
+        wake.notify_all();
+        finished.wait(guard, [&] { return running == 0; });
+    }
+    // Process-wide pool with the given number of threads, created on first use
+    static WorkerPool& shared(int threads) {
+        static mutex poolsLock;
+        static map<int, unique_ptr<WorkerPool>> pools;
+        lock_guard<mutex> guard(poolsLock);
+        unique_ptr<WorkerPool>& pool = pools[threads];
+        if (!pool) pool.reset(new WorkerPool(threads));
+        return *pool;
+    }
+    // Destructor stopping and joining the workers
+    ~WorkerPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& worker : workers) worker.join();
+    }
+};
+
+// Number of significant limbs in a little-endian limb array, 0 for zero
+inline int significantLimbs(const uint64_t* limbs, int length) {
+    while (length > 0 && limbs[length - 1] == 0) --length;
+    return length;
+}
+
+// a += b in place, where b has bLength <= aLength limbs; the carry runs on through a's upper
+// limbs and the carry out of the top limb is returned. a and b may be the same array.
+// The main loop is unrolled by four so the carry stays in the flags register between limbs
+// instead of being saved and restored around every loop test.
+inline uint64_t addLimbsInPlace(uint64_t* a, int aLength, const uint64_t* b, int bLength) {
+    unsigned char carry = 0;
+    int i = 0;
+    for (; i + 4 <= bLength; i += 4) {
+        a[i] = addCarry(a[i], b[i], carry, carry);
+        a[i + 1] = addCarry(a[i + 1], b[i + 1], carry, carry);
+        a[i + 2] = addCarry(a[i + 2], b[i + 2], carry, carry);
+        a[i + 3] = addCarry(a[i + 3], b[i + 3], carry, carry);
+    }
+    for (; i < bLength; ++i) a[i] = addCarry(a[i], b[i], carry, carry);
+    for (; carry && i < aLength; ++i) a[i] = addCarry(a[i], 0, carry, carry);
+    return carry;
+}
+
+// a -= b in place, where b has bLength <= aLength limbs, returning the borrow out of the top limb
+inline uint64_t subtractLimbsInPlace(uint64_t* a, int aLength, const uint64_t* b, int bLength) {
+    unsigned char borrow = 0;
+    int i = 0;
+    for (; i + 4 <= bLength; i += 4) { // Unrolled like addLimbsInPlace
+        a[i] = subtractBorrow(a[i], b[i], borrow, borrow);
+        a[i + 1] = subtractBorrow(a[i + 1], b[i + 1], borrow, borrow);
+        a[i + 2] = subtractBorrow(a[i + 2], b[i + 2], borrow, borrow);
+        a[i + 3] = subtractBorrow(a[i + 3], b[i + 3], borrow, borrow);
+    }
+    for (; i < bLength; ++i) a[i] = subtractBorrow(a[i], b[i], borrow, borrow);
+    for (; borrow && i < aLength; ++i) a[i] = subtractBorrow(a[i], 0, borrow, borrow);
+    return borrow;
+}
+
+// Whether a >= b for two length-limb arrays. Runs the borrow chain of a - b without storing
+// the difference, so the time does not depend on where the numbers first differ.
+inline bool limbsAtLeast(const uint64_t* a, const uint64_t* b, int length) {
+    unsigned char borrow = 0;
+    int i = 0;
+    for (; i + 4 <= length; i += 4) { // Unrolled like addLimbsInPlace
+        subtractBorrow(a[i], b[i], borrow, borrow);
+        subtractBorrow(a[i + 1], b[i + 1], borrow, borrow);
+        subtractBorrow(a[i + 2], b[i + 2], borrow, borrow);
+        subtractBorrow(a[i + 3], b[i + 3], borrow, borrow);
+    }
+    for (; i < length; ++i) subtractBorrow(a[i], b[i], borrow, borrow);
+    return !borrow;
+}
+
+// Batched addition of count independent length-limb numbers stored limb-major, so that limb i
+// of number k is at [i * count + k] and consecutive numbers share a vector register:
+// a[k] += b[k] for every k, with the carry out of number k written to carries[k] (0 or 1).
+// carries must hold count words and also carries the running state between limbs.
+inline void addLimbsBatchScalar(uint64_t* a, const uint64_t* b, int length, int count, uint64_t* carries) {
+    for (int k = 0; k < count; ++k) carries[k] = 0;
+    for (int i = 0; i < length; ++i) {
+        uint64_t* row = a + (size_t)i * count;
+        const uint64_t* other = b + (size_t)i * count;
+        for (int k = 0; k < count; ++k) {
+            unsigned char carry = (unsigned char)carries[k];
+            row[k] = addCarry(row[k], other[k], carry, carry);
+            carries[k] = carry;
+        }
+    }
+}
+
+#ifdef LARGE_NUMBER_X86
+// AVX2 version of addLimbsBatchScalar, four numbers per register. AVX2 has no unsigned
+// 64-bit compare, so both sides are offset by 2^63 before _mm256_cmpgt_epi64; the carry
+// is kept as an all-ones lane mask between limbs.
+__attribute__((target("avx2")))
+inline void addLimbsBatchAvx2(uint64_t* a, const uint64_t* b, int length, int count, uint64_t* carries) {
+    const __m256i signBit = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i allOnes = _mm256_set1_epi64x(-1);
+    int vectorCount = count & ~3; // Numbers handled four at a time
+    for (int k = 0; k < count; ++k) carries[k] = 0;
+    for (int i = 0; i < length; ++i) {
+        uint64_t* row = a + (size_t)i * count;
+        const uint64_t* other = b + (size_t)i * count;
+        for (int k = 0; k < vectorCount; k += 4) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(row + k));
+            __m256i y = _mm256_loadu_si256((const __m256i*)(other + k));
+            __m256i carry = _mm256_loadu_si256((const __m256i*)(carries + k)); // All ones where carrying
+            __m256i sum = _mm256_add_epi64(x, y);
+            __m256i wrapped = _mm256_cmpgt_epi64(_mm256_xor_si256(x, signBit), _mm256_xor_si256(sum, signBit)); // sum < x
+            __m256i full = _mm256_cmpeq_epi64(sum, allOnes); // An incoming carry would wrap it again
+            sum = _mm256_sub_epi64(sum, carry); // Subtracting -1 adds the carry
+            _mm256_storeu_si256((__m256i*)(row + k), sum);
+            _mm256_storeu_si256((__m256i*)(carries + k), _mm256_or_si256(wrapped, _mm256_and_si256(full, carry)));
+        }
+        for (int k = vectorCount; k < count; ++k) { // Leftover numbers, carry kept as a mask too
+            unsigned char carry = (unsigned char)(carries[k] & 1);
+            row[k] = addCarry(row[k], other[k], carry, carry);
+            carries[k] = 0 - (uint64_t)carry;
+        }
+    }
+    for (int k = 0; k < count; ++k) carries[k] &= 1; // Masks back to 0 or 1
+}
+
+// AVX-512 version, eight numbers per register, using the unsigned compare and a mask register for the carry
+__attribute__((target("avx512f")))
+inline void addLimbsBatchAvx512(uint64_t* a, const uint64_t* b, int length, int count, uint64_t* carries) {
+    const __m512i one = _mm512_set1_epi64(1);
+    const __m512i allOnes = _mm512_set1_epi64(-1);
+    int vectorCount = count & ~7; // Numbers handled eight at a time
+    for (int k = 0; k < count; ++k) carries[k] = 0;
+    for (int i = 0; i < length; ++i) {
+        uint64_t* row = a + (size_t)i * count;
+        const uint64_t* other = b + (size_t)i * count;
+        for (int k = 0; k < vectorCount; k += 8) {
+            __m512i x = _mm512_loadu_si512(row + k);
+            __m512i y = _mm512_loadu_si512(other + k);
+            __mmask8 carry = _mm512_test_epi64_mask(_mm512_loadu_si512(carries + k), one);
+            __m512i sum = _mm512_add_epi64(x, y);
+            __mmask8 wrapped = _mm512_cmplt_epu64_mask(sum, x);
+            __mmask8 full = _mm512_cmpeq_epi64_mask(sum, allOnes);
+            sum = _mm512_mask_add_epi64(sum, carry, sum, one);
+            _mm512_storeu_si512(row + k, sum);
+            _mm512_storeu_si512(carries + k, _mm512_maskz_mov_epi64(wrapped | (full & carry), one));
+        }
+        for (int k = vectorCount; k < count; ++k) { // Leftover numbers
+            unsigned char carry = (unsigned char)carries[k];
+            row[k] = addCarry(row[k], other[k], carry, carry);
+            carries[k] = carry;
+        }
+    }
+}
+#endif
+
+// Instruction sets addLimbsBatch can use
+enum class SimdLevel { Scalar, Avx2, Avx512 };
+
+// The widest instruction set this CPU supports, detected once
+inline SimdLevel detectSimdLevel() {
+#ifdef LARGE_NUMBER_X86
+    static const SimdLevel level = __builtin_cpu_supports("avx512f") ? SimdLevel::Avx512
+                                 : __builtin_cpu_supports("avx2") ? SimdLevel::Avx2 : SimdLevel::Scalar;
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+// Name of an instruction set level, for reports
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx512: return "avx512";
+        case SimdLevel::Avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+// addLimbsBatchScalar at the given level, falling back to scalar where the level is unavailable
+inline void addLimbsBatch(uint64_t* a, const uint64_t* b, int length, int count, uint64_t* carries,
+                          SimdLevel level = detectSimdLevel()) {
+#ifdef LARGE_NUMBER_X86
+    if (level == SimdLevel::Avx512) return addLimbsBatchAvx512(a, b, length, count, carries);
+    if (level == SimdLevel::Avx2) return addLimbsBatchAvx2(a, b, length, count, carries);
+#endif
+    (void)level;
+    addLimbsBatchScalar(a, b, length, count, carries);
+}
+
+// Digit size of the batched Montgomery multiply. Every product of two 28-bit digits is below
+// 2^56, so 128 of them can be summed in a 64-bit lane before carries must be propagated and
+// the inner loops have no carry chain; _mm256_mul_epu32/_mm512_mul_epu32 multiply the low
+// 32 bits of each lane.
+const int batch_digit_bits = 28;
+const uint64_t batch_digit_mask = (1ULL << batch_digit_bits) - 1;
+
+// Numbers in one Montgomery batch: one AVX-512 register or two AVX2 registers of 64-bit lanes
+const int batch_lanes = 8;
+
+// Digits of the batched Montgomery form for Bits-bit moduli. R = 2^(28 * digits) >= 4n,
+// which keeps the product of two numbers below 2n below 2n without a final subtraction.
+constexpr int batchDigits(int bits) {
+    return (bits + 2 + batch_digit_bits - 1) / batch_digit_bits;
+}
+
+// Propagate carries through window positions [from, to) of every lane, into position to
+inline void normalizeBatchDigits(uint64_t* window, int from, int to) {
+    for (int p = from; p < to; ++p) {
+        for (int lane = 0; lane < batch_lanes; ++lane) {
+            uint64_t value = window[p * batch_lanes + lane];
+            window[(p + 1) * batch_lanes + lane] += value >> batch_digit_bits;
+            window[p * batch_lanes + lane] = value & batch_digit_mask;
+        }
+    }
+}
+
+// Copy the reduced product out of the window: digits [digits, 2 * digits) normalized into out
+inline void finishBatchProduct(const uint64_t* window, int digits, uint64_t* out) {
+    for (int lane = 0; lane < batch_lanes; ++lane) {
+        uint64_t carry = 0;
+        for (int j = 0; j < digits; ++j) {
+            uint64_t value = window[(digits + j) * batch_lanes + lane] + carry;
+            out[j * batch_lanes + lane] = value & batch_digit_mask;
+            carry = value >> batch_digit_bits; // Zero after the top digit, as the result is below R
+        }
+    }
+}
+
+// Batched Montgomery product out = a * b / R mod n for batch_lanes independent moduli, where
+// every number is stored digit-major (digit j of lane k at [j * batch_lanes + k]) in normalized
+// 28-bit digits. a and b must be below 2n; out is below 2n but not fully reduced. nPrime holds
+// -n^-1 mod 2^28 for each lane and window must hold 2 * digits * batch_lanes words. Row i adds
+// a * b[i] and m * n into a window that slides up one digit per row, so the shift by 2^28 is
+// free. out may alias a or b.
+inline void montgomeryMultiplyBatchScalar(const uint64_t* a, const uint64_t* b, const uint64_t* n, const uint64_t* nPrime,
+                                          int digits, uint64_t* window, uint64_t* out) {
+    for (int k = 0; k < 2 * digits * batch_lanes; ++k) window[k] = 0;
+    for (int i = 0; i < digits; ++i) {
+        uint64_t* row = window + i * batch_lanes; // Position i of the window
+        const uint64_t* bRow = b + i * batch_lanes;
+        uint64_t m[batch_lanes];
+        for (int lane = 0; lane < batch_lanes; ++lane) {
+            uint64_t low = row[lane] + a[lane] * bRow[lane];
+            m[lane] = (low * nPrime[lane]) & batch_digit_mask; // Makes position i divisible by 2^28
+            low += m[lane] * n[lane];
+            row[batch_lanes + lane] += low >> batch_digit_bits;
+        }
+        for (int j = 1; j < digits; ++j) {
+            for (int lane = 0; lane < batch_lanes; ++lane) {
+                row[j * batch_lanes + lane] += a[j * batch_lanes + lane] * bRow[lane] + m[lane] * n[j * batch_lanes + lane];
+            }
+        }
+        if ((i & 63) == 63 && i + 1 < digits) normalizeBatchDigits(window, i + 1, i + digits); // Headroom for 128 more products
+    }
+    finishBatchProduct(window, digits, out);
+}
+
+#ifdef LARGE_NUMBER_X86
+// AVX2 version of montgomeryMultiplyBatchScalar, two registers of four lanes
+__attribute__((target("avx2")))
+inline void montgomeryMultiplyBatchAvx2(const uint64_t* a, const uint64_t* b, const uint64_t* n, const uint64_t* nPrime,
+                                        int digits, uint64_t* window, uint64_t* out) {
+    const __m256i mask = _mm256_set1_epi64x(batch_digit_mask);
+    for (int k = 0; k < 2 * digits * batch_lanes; ++k) window[k] = 0;
+    for (int i = 0; i < digits; ++i) {
+        uint64_t* row = window + i * batch_lanes;
+        __m256i bi[2], m[2];
+        for (int h = 0; h < 2; ++h) {
+            bi[h] = _mm256_loadu_si256((const __m256i*)(b + i * batch_lanes + 4 * h));
+            __m256i low = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)(row + 4 * h)),
+                                           _mm256_mul_epu32(_mm256_loadu_si256((const __m256i*)(a + 4 * h)), bi[h]));
+            m[h] = _mm256_and_si256(_mm256_mul_epu32(low, _mm256_loadu_si256((const __m256i*)(nPrime + 4 * h))), mask);
+            low = _mm256_add_epi64(low, _mm256_mul_epu32(m[h], _mm256_loadu_si256((const __m256i*)(n + 4 * h))));
+            __m256i* next = (__m256i*)(row + batch_lanes + 4 * h);
+            _mm256_storeu_si256(next, _mm256_add_epi64(_mm256_loadu_si256(next), _mm256_srli_epi64(low, batch_digit_bits)));
+        }
+        for (int j = 1; j < digits; ++j) {
+            for (int h = 0; h < 2; ++h) {
+                int offset = j * batch_lanes + 4 * h;
+                __m256i sum = _mm256_add_epi64(_mm256_mul_epu32(_mm256_loadu_si256((const __m256i*)(a + offset)), bi[h]),
+                                               _mm256_mul_epu32(m[h], _mm256_loadu_si256((const __m256i*)(n + offset))));
+                __m256i* target = (__m256i*)(row + offset);
+                _mm256_storeu_si256(target, _mm256_add_epi64(_mm256_loadu_si256(target), sum));
+            }
+        }
+        if ((i & 63) == 63 && i + 1 < digits) normalizeBatchDigits(window, i + 1, i + digits);
+    }
+    finishBatchProduct(window, digits, out);
+}
+
+// AVX-512 version of montgomeryMultiplyBatchScalar, all eight lanes in one register.
+// GCC 12 flags the undefined pass-through operand inside its own _mm512_mul_epu32 as
+// uninitialized under -Wall, so those warnings are off for this function.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+inline void montgomeryMultiplyBatchAvx512(const uint64_t* a, const uint64_t* b, const uint64_t* n, const uint64_t* nPrime,
+                                          int digits, uint64_t* window, uint64_t* out) {
+    const __m512i mask = _mm512_set1_epi64(batch_digit_mask);
+    const __m512i nPrimes = _mm512_loadu_si512(nPrime);
+    for (int k = 0; k < 2 * digits * batch_lanes; ++k) window[k] = 0;
+    for (int i = 0; i < digits; ++i) {
+        uint64_t* row = window + i * batch_lanes;
+        __m512i bi = _mm512_loadu_si512(b + i * batch_lanes);
+        __m512i low = _mm512_add_epi64(_mm512_loadu_si512(row), _mm512_mul_epu32(_mm512_loadu_si512(a), bi));
+        __m512i m = _mm512_and_si512(_mm512_mul_epu32(low, nPrimes), mask);
+        low = _mm512_add_epi64(low, _mm512_mul_epu32(m, _mm512_loadu_si512(n)));
+        _mm512_storeu_si512(row + batch_lanes, _mm512_add_epi64(_mm512_loadu_si512(row + batch_lanes),
+                                                                _mm512_srli_epi64(low, batch_digit_bits)));
+        for (int j = 1; j < digits; ++j) {
+            int offset = j * batch_lanes;
+            __m512i sum = _mm512_add_epi64(_mm512_mul_epu32(_mm512_loadu_si512(a + offset), bi),
+                                           _mm512_mul_epu32(m, _mm512_loadu_si512(n + offset)));
+            _mm512_storeu_si512(row + offset, _mm512_add_epi64(_mm512_loadu_si512(row + offset), sum));
+        }
+        if ((i & 63) == 63 && i + 1 < digits) normalizeBatchDigits(window, i + 1, i + digits);
+    }
+    finishBatchProduct(window, digits, out);
+}
+#pragma GCC diagnostic pop
+#endif
+
+// montgomeryMultiplyBatchScalar at the given level, falling back to scalar where it is unavailable
+inline void montgomeryMultiplyBatch(const uint64_t* a, const uint64_t* b, const uint64_t* n, const uint64_t* nPrime,
+                                    int digits, uint64_t* window, uint64_t* out, SimdLevel level = detectSimdLevel()) {
+#ifdef LARGE_NUMBER_X86
+    if (level == SimdLevel::Avx512) return montgomeryMultiplyBatchAvx512(a, b, n, nPrime, digits, window, out);
+    if (level == SimdLevel::Avx2) return montgomeryMultiplyBatchAvx2(a, b, n, nPrime, digits, window, out);
+#endif
+    (void)level;
+    montgomeryMultiplyBatchScalar(a, b, n, nPrime, digits, window, out);
+}
+
+// Schoolbook product of two limb arrays. product must hold aLength + bLength limbs
+// and must not overlap either input.
+inline void multiplyLimbs(const uint64_t* a, int aLength, const uint64_t* b, int bLength, uint64_t* product) {
+    for (int i = 0; i < aLength + bLength; ++i) product[i] = 0;
+    for (int i = 0; i < aLength; ++i) {
+        uint64_t carry = 0;
+        for (int j = 0; j < bLength; ++j) {
+            unsigned __int128 t = (unsigned __int128)a[i] * b[j] + product[i + j] + carry;
+            product[i + j] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
+        }
+        product[i + bLength] = carry;
+    }
+}
+
+// Square of a limb array, computing each cross product a[i] * a[j] (i < j) once and
+// doubling it. square must hold 2 * length limbs and must not overlap a.
+inline void squareLimbs(const uint64_t* a, int length, uint64_t* square) {
+    for (int i = 0; i < 2 * length; ++i) square[i] = 0;
+    for (int i = 0; i < length; ++i) { // Cross products above the diagonal
+        uint64_t carry = 0;
+        for (int j = i + 1; j < length; ++j) {
+            unsigned __int128 t = (unsigned __int128)a[i] * a[j] + square[i + j] + carry;
+            square[i + j] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
+        }
+        square[i + length] = carry;
+    }
+    uint64_t topBit = 0; // Double the cross products
+    for (int i = 0; i < 2 * length; ++i) {
+        uint64_t next = square[i] >> 63;
+        square[i] = (square[i] << 1) | topBit;
+        topBit = next;
+    }
+    uint64_t carry = 0; // Add the diagonal squares
+    for (int i = 0; i < length; ++i) {
+        unsigned __int128 t = (unsigned __int128)a[i] * a[i] + square[2 * i] + carry;
+        square[2 * i] = (uint64_t)t;
+        t = (unsigned __int128)square[2 * i + 1] + (uint64_t)(t >> 64);
+        square[2 * i + 1] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+    }
+}
+
+// Operand size in limbs from which multiplyKaratsuba splits instead of using schoolbook.
+// Tune it with the crossover benchmark; values below 4 are treated as 4.
+extern int karatsuba_threshold;
+
+// Scratch limbs multiplyKaratsuba needs for length-limb operands, for any threshold
+constexpr int karatsubaScratchLimbs(int length) {
+    return length < 4 ? 0 : 4 * ((length + 1) / 2 + 1) + karatsubaScratchLimbs((length + 1) / 2 + 1);
+}
+
+// Add two limb arrays of possibly different lengths (bLength <= aLength) into sum, returning the carry
+inline uint64_t addLimbs(const uint64_t* a, int aLength, const uint64_t* b, int bLength, uint64_t* sum) {
+    unsigned char carry = 0;
+    int i = 0;
+    for (; i < bLength; ++i) sum[i] = addCarry(a[i], b[i], carry, carry);
+    for (; i < aLength; ++i) sum[i] = addCarry(a[i], 0, carry, carry);
+    return carry;
+}
+
+// Product of two length-limb arrays (a == b selects squaring). Above karatsuba_threshold
+// the operands are split in halves and z1 = (a0 + a1)(b0 + b1) - z0 - z2 replaces the
+// fourth half-size product. product must hold 2 * length limbs and not overlap the inputs;
+// scratch must hold karatsubaScratchLimbs(length) limbs.
+inline void multiplyKaratsuba(const uint64_t* a, const uint64_t* b, int length, uint64_t* product, uint64_t* scratch) {
+    bool squaring = (a == b);
+    int threshold = karatsuba_threshold < 4 ? 4 : karatsuba_threshold;
+    if (length < threshold) {
+        if (squaring) squareLimbs(a, length, product);
+        else multiplyLimbs(a, length, b, length, product);
+        return;
+    }
+    int low = length / 2; // Limbs in the low halves
+    int high = length - low; // Limbs in the high halves, high >= low
+    int sumLength = high + 1;
+
+    // z0 = a0 * b0 into the low half of product, z2 = a1 * b1 into the high half
+    multiplyKaratsuba(a, b, low, product, scratch);
+    if (squaring) multiplyKaratsuba(a + low, a + low, high, product + 2 * low, scratch);
+    else multiplyKaratsuba(a + low, b + low, high, product + 2 * low, scratch);
+
+    // z1 = (a0 + a1)(b0 + b1) - z0 - z2
+    uint64_t* sumA = scratch;
+    uint64_t* sumB = sumA + sumLength;
+    uint64_t* middle = sumB + sumLength; // 2 * sumLength limbs
+    uint64_t* rest = middle + 2 * sumLength;
+    sumA[high] = addLimbs(a + low, high, a, low, sumA);
+    if (squaring) {
+        multiplyKaratsuba(sumA, sumA, sumLength, middle, rest);
+    } else {
+        sumB[high] = addLimbs(b + low, high, b, low, sumB);
+        multiplyKaratsuba(sumA, sumB, sumLength, middle, rest);
+    }
+    subtractLimbsInPlace(middle, 2 * sumLength, product, 2 * low); // middle -= z0
+    subtractLimbsInPlace(middle, 2 * sumLength, product + 2 * low, 2 * high); // middle -= z2
+
+    // product += z1 * 2^(64 * low)
+    addLimbsInPlace(product + low, 2 * length - low, middle, min(2 * sumLength, 2 * length - low));
+}
+
+// Knuth's Algorithm D (TAOCP 4.3.1) on 64-bit limbs with __int128 intermediates.
+// Divides u (uLength limbs) by v (vLength limbs), writing uLength limbs of quotient and
+// vLength limbs of remainder; either output may be null when it is not needed.
+// scratch must hold uLength + vLength + 1 limbs. A zero divisor gives a zero quotient
+// and leaves the dividend as the remainder (truncated to vLength limbs).
+inline void divideLimbs(const uint64_t* u, int uLength, const uint64_t* v, int vLength,
+                        uint64_t* quotient, uint64_t* remainder, uint64_t* scratch) {
+    int m = significantLimbs(u, uLength); // Significant dividend limbs
+    int n = significantLimbs(v, vLength); // Significant divisor limbs
+    if (quotient) {
+        for (int i = 0; i < uLength; ++i) quotient[i] = 0;
+    }
+    if (n == 0 || m < n) { // Division by zero, or dividend smaller than divisor
+        if (remainder) {
+            for (int i = 0; i < vLength; ++i) remainder[i] = i < uLength ? u[i] : 0;
+        }
+        return;
+    }
+    if (n == 1) { // Short division by a single limb
+        unsigned __int128 rest = 0;
+        for (int i = m - 1; i >= 0; --i) {
+            unsigned __int128 current = (rest << 64) | u[i];
+            if (quotient) quotient[i] = (uint64_t)(current / v[0]);
+            rest = current % v[0];
+        }
+        if (remainder) {
+            for (int i = 0; i < vLength; ++i) remainder[i] = 0;
+            remainder[0] = (uint64_t)rest;
+        }
+        return;
+    }
+
+    // D1: normalise so the top divisor limb has its high bit set
+    uint64_t* un = scratch; // m + 1 limbs of shifted dividend
+    uint64_t* vn = scratch + m + 1; // n limbs of shifted divisor
+    int shift = __builtin_clzll(v[n - 1]);
+    for (int i = n - 1; i > 0; --i) {
+        vn[i] = shift ? (v[i] << shift) | (v[i - 1] >> (64 - shift)) : v[i];
+    }
+    vn[0] = v[0] << shift;
+    un[m] = shift ? u[m - 1] >> (64 - shift) : 0;
+    for (int i = m - 1; i > 0; --i) {
+        un[i] = shift ? (u[i] << shift) | (u[i - 1] >> (64 - shift)) : u[i];
+    }
+    un[0] = u[0] << shift;
+
+    for (int j = m - n; j >= 0; --j) {
+        // D3: estimate the quotient limb from the top two dividend limbs
+        unsigned __int128 numerator = ((unsigned __int128)un[j + n] << 64) | un[j + n - 1];
+        unsigned __int128 qhat = numerator / vn[n - 1];
+        unsigned __int128 rhat = numerator % vn[n - 1];
+        while ((qhat >> 64) != 0 || qhat * vn[n - 2] > ((rhat << 64) | un[j + n - 2])) {
+            qhat--; // At most two corrections
+            rhat += vn[n - 1];
+            if ((rhat >> 64) != 0) break;
+        }
+
+        // D4: multiply and subtract qhat * vn from the current dividend window
+        uint64_t carry = 0; // High half of the running product
+        uint64_t borrow = 0; // Borrow of the running subtraction
+        for (int i = 0; i < n; ++i) {
+            unsigned __int128 product = qhat * vn[i] + carry;
+            carry = (uint64_t)(product >> 64);
+            unsigned __int128 difference = (unsigned __int128)un[i + j] - (uint64_t)product - borrow;
+            un[i + j] = (uint64_t)difference;
+            borrow = (uint64_t)(difference >> 64) & 1;
+        }
+        unsigned __int128 difference = (unsigned __int128)un[j + n] - carry - borrow;
+        un[j + n] = (uint64_t)difference;
+        borrow = (uint64_t)(difference >> 64) & 1;
+
+        // D5/D6: the estimate was one too large, add the divisor back
+        if (borrow) {
+            qhat--;
+            uint64_t addCarry = 0;
+            for (int i = 0; i < n; ++i) {
+                unsigned __int128 sum = (unsigned __int128)un[i + j] + vn[i] + addCarry;
+                un[i + j] = (uint64_t)sum;
+                addCarry = (uint64_t)(sum >> 64);
+            }
+            un[j + n] += addCarry;
+        }
+        if (quotient) quotient[j] = (uint64_t)qhat;
+    }
+
+    // D8: unnormalise the remainder
+    if (remainder) {
+        for (int i = 0; i < vLength; ++i) remainder[i] = 0;
+        for (int i = 0; i < n; ++i) {
+            remainder[i] = shift ? (un[i] >> shift) | (un[i + 1] << (64 - shift)) : un[i];
+        }
+    }
+}
+
+template <int Bits>
+class MontgomeryContext;
+template <int Bits>
+class BarrettContext;
+
+// Fixed-width large number stored as a contiguous array of 64-bit limbs.
+// limbs[0] holds the least significant 64 bits. The width is a template parameter
+// so that 1024, 2048 and 4096-bit values live inline without any heap allocation.
+template <int Bits>
+class FixedLargeNumber {
+    static_assert(Bits % bits_per_node == 0, "Bit width must be a multiple of 64");
+public:
+    static const int limb_count = Bits / bits_per_node; // Number of 64-bit limbs
+private:
+    array<uint64_t, limb_count> limbs; // Limbs of the number, least significant first
+
+    // Contexts and other widths work directly on the limbs
+    template <int OtherBits>
+    friend class MontgomeryContext;
+    template <int OtherBits>
+    friend class BarrettContext;
+    template <int OtherBits>
+    friend class FixedLargeNumber;
+
+    // Add other to this number in place and return the carry out of the top limb
+    uint64_t addInPlace(const FixedLargeNumber& other) {
+        return addLimbsInPlace(limbs.data(), limb_count, other.limbs.data(), limb_count);
+    }
+    // Subtract other from this number in place and return the borrow out of the top limb
+    uint64_t subtractInPlace(const FixedLargeNumber& other) {
+        return subtractLimbsInPlace(limbs.data(), limb_count, other.limbs.data(), limb_count);
+    }
+    // Compute (this + other) mod m in place, assuming both operands are already below m
+    void addMod(const FixedLargeNumber& other, const FixedLargeNumber& m) {
+        uint64_t carry = addInPlace(other); // The sum can exceed the fixed width
+        if (carry || *this >= m) {
+            subtractInPlace(m); // One subtraction is enough since the sum is below 2m
+        }
+    }
+public:
+    // Default constructor, the value is zero
+    FixedLargeNumber() {
+        limbs.fill(0);
+    }
+    // Constructor to initialize with a single uint64_t value
+    FixedLargeNumber(uint64_t val) {
+        limbs.fill(0);
+        limbs[0] = val; // Store the value in the least significant limb
+    }
+    // Read-only access to a limb, 0 being the least significant
+    uint64_t limb(int index) const {
+        return limbs[index];
+    }
+    // Write access to a limb, 0 being the least significant
+    void setLimb(int index, uint64_t value) {
+        limbs[index] = value;
+    }
+    // Return the bit at the given position, 0 being the least significant
+    bool testBit(int bit) const {
+        return (limbs[bit / 64] >> (bit % 64)) & 1;
+    }
+    // Number of significant bits, 0 for zero
+    int bitLength() const {
+        for (int i = limb_count - 1; i >= 0; --i) {
+            if (limbs[i]) return i * 64 + 64 - __builtin_clzll(limbs[i]);
+        }
+        return 0;
+    }
+    // Remainder of the number divided by a single-limb divisor
+    uint64_t modSmall(uint64_t divisor) const {
+        unsigned __int128 remainder = 0;
+        for (int i = limb_count - 1; i >= 0; --i) {
+            remainder = ((remainder << 64) | limbs[i]) % divisor; // Long division one limb at a time
+        }
+        return (uint64_t)remainder;
+    }
+    // Generate a random number using every bit of the fixed width, from the calling thread's generator
+    void generateRandom() {
+        generateRandom(threadRandom());
+    }
+    // Generate a random number using every bit of the fixed width, from the given source
+    void generateRandom(RandomSource& source) {
+        source.fill(limbs.data(), limb_count);
+        limbs[limb_count - 1] |= (1ULL << 63); // Ensure the top limb makes the number full width
+    }
+    // Check if the number is even
+    bool isEven() const {
+        return !(limbs[0] & 1); // Check if the least significant bit is 0
+    }
+    // Check if the number is zero
+    bool isZero() const {
+        for (int i = 0; i < limb_count; ++i) {
+            if (limbs[i] != 0) return false; // Return false if any limb is not zero
+        }
+        return true;
+    }
+    // Check if the number is one
+    bool isOne() const {
+        if (limbs[0] != 1) return false; // Check the least significant limb
+        for (int i = 1; i < limb_count; ++i) {
+            if (limbs[i] != 0) return false; // Every other limb must be zero
+        }
+        return true;
+    }
+    // Divide the large number by two
+    void divideByTwo() {
+        for (int i = 0; i < limb_count - 1; ++i) {
+            limbs[i] = (limbs[i] >> 1) | (limbs[i + 1] << 63); // Pull in the low bit of the next limb
+        }
+        limbs[limb_count - 1] >>= 1;
+    }
+    // Subtract another FixedLargeNumber from this one (wraps modulo 2^Bits)
+    void subtract(const FixedLargeNumber& other) {
+        subtractInPlace(other);
+    }
+    // Divide by divisor, giving quotient and remainder with Knuth's Algorithm D.
+    // The divisor may have a different width; a zero divisor gives a zero quotient.
+    template <int DivisorBits>
+    void divmod(const FixedLargeNumber<DivisorBits>& divisor, FixedLargeNumber& quotient,
+                FixedLargeNumber<DivisorBits>& remainder) const {
+        uint64_t scratch[limb_count + FixedLargeNumber<DivisorBits>::limb_count + 1]; // Normalised operands
+        divideLimbs(limbs.data(), limb_count, divisor.limbs.data(), FixedLargeNumber<DivisorBits>::limb_count,
+                    quotient.limbs.data(), remainder.limbs.data(), scratch);
+    }
+    // Calculate modulus of this number with another FixedLargeNumber of any width
+    template <int ModulusBits>
+    FixedLargeNumber<ModulusBits> mod(const FixedLargeNumber<ModulusBits>& m) const {
+        FixedLargeNumber<ModulusBits> result;
+        uint64_t scratch[limb_count + FixedLargeNumber<ModulusBits>::limb_count + 1]; // Normalised operands
+        divideLimbs(limbs.data(), limb_count, m.limbs.data(), FixedLargeNumber<ModulusBits>::limb_count,
+                    nullptr, result.limbs.data(), scratch);
+        return result;
+    }
+    // Perform modular multiplication of this number with another FixedLargeNumber:
+    // the full double-width product is reduced with one long division
+    FixedLargeNumber modMul(const FixedLargeNumber& other, const FixedLargeNumber& m) const {
+        return (*this * other).mod(m);
+    }
+    // Full-width product, schoolbook below karatsuba_threshold limbs and Karatsuba above.
+    // Multiplying a number by itself takes the squaring path.
+    FixedLargeNumber<2 * Bits> operator*(const FixedLargeNumber& other) const {
+        FixedLargeNumber<2 * Bits> product;
+        uint64_t scratch[karatsubaScratchLimbs(limb_count) + 1];
+        multiplyKaratsuba(limbs.data(), other.limbs.data(), limb_count, product.limbs.data(), scratch);
+        return product;
+    }
+    // Full-width square, computing each cross product once
+    FixedLargeNumber<2 * Bits> square() const {
+        return *this * *this;
+    }
+    // Perform modular exponentiation. Odd moduli go through Montgomery multiplication,
+    // even moduli fall back to binary exponentiation with modMul.
+    FixedLargeNumber modPow(const FixedLargeNumber& exponent, const FixedLargeNumber& m) const {
+        if (m.isZero() || m.isOne()) return FixedLargeNumber(0); // No residue, or everything is zero mod one
+        if (!m.isEven()) {
+            MontgomeryContext<Bits> context(m); // Precompute R^2 mod m and m'
+            return context.modPow(*this, exponent);
+        }
+
+        BarrettContext<Bits> barrett(m); // Every step reduces by the same modulus
+        FixedLargeNumber result(1); // Initialize result to 1
+        FixedLargeNumber base = this->mod(m); // Reduce base with modulus
+
+        // Left-to-right binary exponentiation reading the exponent bits directly
+        for (int bit = exponent.bitLength() - 1; bit >= 0; --bit) {
+            result = barrett.square(result); // Square result and take modulus
+            if (exponent.testBit(bit)) {
+                result = barrett.multiply(result, base); // Multiply result with base and take modulus
+            }
+        }
+        return result;
+    }
+    // Comparison operator for equality
+    bool operator==(const FixedLargeNumber& other) const {
+        return limbs == other.limbs;
+    }
+    // Comparison operator for greater than or equal to
+    bool operator>=(const FixedLargeNumber& other) const {
+        return limbsAtLeast(limbs.data(), other.limbs.data(), limb_count);
+    }
+    // Addition operator (wraps modulo 2^Bits)
+    FixedLargeNumber operator+(const FixedLargeNumber& other) const {
+        FixedLargeNumber result = *this;
+        result.addInPlace(other);
+        return result;
+    }
+    // Subtraction operator (wraps modulo 2^Bits)
+    FixedLargeNumber operator-(const FixedLargeNumber& other) const {
+        FixedLargeNumber result = *this; // Copy this number
+        result.subtractInPlace(other); // Subtract other from the copy
+        return result;
+    }
+    // In-place addition (wraps modulo 2^Bits)
+    FixedLargeNumber& operator+=(const FixedLargeNumber& other) {
+        addInPlace(other);
+        return *this;
+    }
+    // In-place subtraction (wraps modulo 2^Bits)
+    FixedLargeNumber& operator-=(const FixedLargeNumber& other) {
+        subtractInPlace(other);
+        return *this;
+    }
+    // In-place multiplication keeping the low Bits of the product
+    FixedLargeNumber& operator*=(const FixedLargeNumber& other) {
+        uint64_t product[2 * limb_count];
+        uint64_t scratch[karatsubaScratchLimbs(limb_count) + 1];
+        multiplyKaratsuba(limbs.data(), other.limbs.data(), limb_count, product, scratch);
+        for (int i = 0; i < limb_count; ++i) limbs[i] = product[i];
+        return *this;
+    }
+    // In-place reduction modulo m
+    FixedLargeNumber& operator%=(const FixedLargeNumber& m) {
+        uint64_t scratch[2 * limb_count + 1];
+        uint64_t remainder[limb_count];
+        divideLimbs(limbs.data(), limb_count, m.limbs.data(), limb_count, nullptr, remainder, scratch);
+        for (int i = 0; i < limb_count; ++i) limbs[i] = remainder[i];
+        return *this;
+    }
+    // In-place right shift by the given number of bits
+    FixedLargeNumber& operator>>=(int bits) {
+        int limbShift = bits / 64; // Whole limbs dropped
+        int bitShift = bits % 64; // Remaining shift within a limb
+        for (int i = 0; i < limb_count; ++i) {
+            int source = i + limbShift;
+            uint64_t low = source < limb_count ? limbs[source] : 0;
+            uint64_t high = source + 1 < limb_count ? limbs[source + 1] : 0;
+            limbs[i] = bitShift ? (low >> bitShift) | (high << (64 - bitShift)) : low;
+        }
+        return *this;
+    }
+    // Check if the number is prime using Miller-Rabin primality test with 5 rounds
+    bool isPrime() const {
+        return isPrime(5, 1);
+    }
+    // Check if the number is prime using the given number of Miller-Rabin rounds.
+    // The witness loop runs entirely in Montgomery form against a context built once for n.
+    // With more than one thread the rounds are spread over a shared WorkerPool and the
+    // remaining rounds are skipped as soon as one witness proves n composite. Witnesses
+    // are drawn up front, so the verdict matches the serial path for the same witnesses.
+    bool isPrime(int rounds, int threads) const {
+        if (isEven()) return false; // Exclude even numbers
+        if (isOne()) return false; // One is not prime
+        if (*this == FixedLargeNumber(3)) return true; // Smallest odd prime with no valid witness range
+
+        MontgomeryContext<Bits> context(*this); // Shared by every witness round
+        FixedLargeNumber d = *this - FixedLargeNumber(1); // d = n - 1
+        int s = 0; // Count of factors of 2 in d
+        while (d.isEven()) {
+            d.divideByTwo(); // Divide d by 2
+            s++; // Increase count of factors of 2
+        }
+
+        vector<FixedLargeNumber> witnesses(rounds);
+        for (int i = 0; i < rounds; i++) {
+            witnesses[i].generateRandom(); // Generate random number
+            witnesses[i] = witnesses[i].mod(*this); // Reduce it modulo n
+        }
+
+        if (threads <= 1 || rounds <= 1) {
+            for (int i = 0; i < rounds; i++) {
+                if (provesComposite(context, witnesses[i], d, s)) return false; // n is not prime
+            }
+            return true; // n is probably prime
+        }
+
+        atomic<int> nextRound(0); // Next witness to hand out
+        atomic<bool> composite(false); // Set once any witness proves n composite
+        WorkerPool::shared(threads).run([&](int) {
+            int round;
+            while (!composite.load(memory_order_relaxed) && (round = nextRound++) < rounds) {
+                if (provesComposite(context, witnesses[round], d, s)) {
+                    composite.store(true, memory_order_relaxed); // Cancels the remaining rounds
+                }
+            }
+        });
+        return !composite.load(); // n is probably prime unless a witness was found
+    }
+    // One Miller-Rabin round: true when a proves n = 2^s * d + 1 composite
+    static bool provesComposite(const MontgomeryContext<Bits>& context, const FixedLargeNumber& a,
+                                const FixedLargeNumber& d, int s) {
+        if (a.isZero() || a.isOne()) return false; // Skip if a is 0 or 1
+
+        const FixedLargeNumber& one = context.one(); // 1 in Montgomery form
+        FixedLargeNumber minusOne = context.getModulus() - one; // n - 1 in Montgomery form
+        FixedLargeNumber x = context.powMontgomery(context.toMontgomery(a), d); // x = a^d mod n
+
+        if (x == one || x == minusOne) return false; // x is either 1 or n - 1
+
+        for (int j = 0; j < s - 1; j++) {
+            x = context.square(x); // Square x in Montgomery form
+            if (x == minusOne) { // Check if x is n - 1
+                return false; // Not a witness for compositeness
+            }
+        }
+        return true; // a is a witness, n is composite
+    }
+    // Display the number, least significant limb first like LargeNumber
+    void display() const {
+        for (int i = 0; i < limb_count; ++i) {
+            cout << limbs[i] << " "; // Print each limb value
+        }
+        cout << endl;
+    }
+};
+
+// Montgomery arithmetic for a fixed odd modulus n.
+// Numbers are kept in Montgomery form aR mod n with R = 2^Bits, so that a modular
+// multiplication costs one word-level CIOS pass instead of a full division.
+// Build one context per modulus and reuse it for every multiplication against it.
+template <int Bits>
+class MontgomeryContext {
+public:
+    typedef FixedLargeNumber<Bits> Number;
+    static const int limb_count = Number::limb_count;
+    static const int max_window_bits = 6; // Largest sliding window, 32 precomputed odd powers
+private:
+    Number modulus; // The odd modulus n
+    uint64_t nPrime; // -n^-1 mod 2^64
+    Number rSquared; // R^2 mod n, used to convert into Montgomery form
+    Number rModN; // R mod n, which is 1 in Montgomery form
+    bool constantTime; // Avoid data-dependent branches and exponent-dependent timing
+
+    // Final conditional subtraction of n from the (limb_count + 1)-limb value t
+    void reduceOnce(uint64_t* t, Number& result) const {
+        Number difference;
+        uint64_t borrow = 0; // Borrow between limbs
+        for (int i = 0; i < limb_count; ++i) {
+            unsigned __int128 diff = (unsigned __int128)t[i] - modulus.limbs[i] - borrow;
+            difference.limbs[i] = (uint64_t)diff;
+            borrow = (uint64_t)(diff >> 64) & 1;
+        }
+        // t >= n exactly when the top limb absorbs the borrow
+        bool useDifference = t[limb_count] >= borrow;
+        if (constantTime) {
+            uint64_t mask = 0 - (uint64_t)useDifference; // All ones when the difference is kept
+            for (int i = 0; i < limb_count; ++i) {
+                result.limbs[i] = (difference.limbs[i] & mask) | (t[i] & ~mask);
+            }
+        } else if (useDifference) {
+            result = difference;
+        } else {
+            for (int i = 0; i < limb_count; ++i) result.limbs[i] = t[i];
+        }
+    }
+public:
+    // Constructor precomputing n' and R^2 mod n. The modulus must be odd and greater than one.
+    MontgomeryContext(const Number& n, bool constantTime = false) : modulus(n), constantTime(constantTime) {
+        uint64_t inverse = n.limbs[0]; // Correct to 3 bits for any odd n
+        for (int i = 0; i < 5; ++i) {
+            inverse *= 2 - n.limbs[0] * inverse; // Newton step doubles the correct bits
+        }
+        nPrime = 0 - inverse;
+
+        rModN = Number(1);
+        for (int i = 0; i < Bits; ++i) {
+            Number doubled = rModN;
+            rModN.addMod(doubled, modulus); // Ends at 2^Bits mod n
+        }
+        rSquared = rModN;
+        for (int i = 0; i < Bits; ++i) {
+            Number doubled = rSquared;
+            rSquared.addMod(doubled, modulus); // Ends at 2^(2 * Bits) mod n
+        }
+    }
+    // The modulus this context was built for
+    const Number& getModulus() const {
+        return modulus;
+    }
+    // The value one in Montgomery form
+    const Number& one() const {
+        return rModN;
+    }
+    // Montgomery product a * b * R^-1 mod n using the CIOS method
+    Number multiply(const Number& a, const Number& b) const {
+        uint64_t t[limb_count + 2] = {}; // Accumulator with two spare limbs
+        for (int i = 0; i < limb_count; ++i) {
+            // t += a * b[i]
+            uint64_t carry = 0;
+            for (int j = 0; j < limb_count; ++j) {
+                unsigned __int128 product = (unsigned __int128)a.limbs[j] * b.limbs[i] + t[j] + carry;
+                t[j] = (uint64_t)product;
+                carry = (uint64_t)(product >> 64);
+            }
+            unsigned __int128 top = (unsigned __int128)t[limb_count] + carry;
+            t[limb_count] = (uint64_t)top;
+            t[limb_count + 1] = (uint64_t)(top >> 64);
+
+            // t = (t + m * n) / 2^64, with m chosen so the low limb cancels
+            uint64_t m = t[0] * nPrime;
+            unsigned __int128 product = (unsigned __int128)m * modulus.limbs[0] + t[0];
+            carry = (uint64_t)(product >> 64);
+            for (int j = 1; j < limb_count; ++j) {
+                product = (unsigned __int128)m * modulus.limbs[j] + t[j] + carry;
+                t[j - 1] = (uint64_t)product;
+                carry = (uint64_t)(product >> 64);
+            }
+            top = (unsigned __int128)t[limb_count] + carry;
+            t[limb_count - 1] = (uint64_t)top;
+            t[limb_count] = t[limb_count + 1] + (uint64_t)(top >> 64);
+        }
+        Number result;
+        reduceOnce(t, result); // Bring the result below n
+        return result;
+    }
+    // Montgomery reduction t * R^-1 mod n of a double-width value t below n * R
+    Number reduce(const FixedLargeNumber<2 * Bits>& value) const {
+        uint64_t t[2 * limb_count + 1]; // Working copy with one spare limb for the final carry
+        for (int i = 0; i < 2 * limb_count; ++i) t[i] = value.limbs[i];
+        t[2 * limb_count] = 0;
+        for (int i = 0; i < limb_count; ++i) {
+            uint64_t m = t[i] * nPrime; // Cancels limb i
+            uint64_t carry = 0;
+            for (int j = 0; j < limb_count; ++j) {
+                unsigned __int128 product = (unsigned __int128)m * modulus.limbs[j] + t[i + j] + carry;
+                t[i + j] = (uint64_t)product;
+                carry = (uint64_t)(product >> 64);
+            }
+            for (int j = i + limb_count; carry && j <= 2 * limb_count; ++j) {
+                t[j] += carry;
+                carry = (t[j] < carry); // Carry out of this limb
+            }
+        }
+        Number result;
+        reduceOnce(t + limb_count, result); // Upper half, bring it below n
+        return result;
+    }
+    // Montgomery square a * a * R^-1 mod n: a full square computing each cross product
+    // once, followed by a separate reduction. The reduction's carry loop stops early, so
+    // the constant-time variant squares through the fixed-length CIOS multiply instead.
+    Number square(const Number& a) const {
+        if (constantTime) return multiply(a, a);
+        return reduce(a.square());
+    }
+    // Convert a (any value) into Montgomery form aR mod n. CIOS with a below R and R^2 mod n
+    // below n ends below 2n, so the final conditional subtraction fully reduces it and no
+    // comparison or division of a is needed, in either variant.
+    Number toMontgomery(const Number& a) const {
+        return multiply(a, rSquared);
+    }
+    // Convert a Montgomery-form value back to a normal residue
+    Number fromMontgomery(const Number& a) const {
+        return multiply(a, Number(1));
+    }
+    // Fill table with the odd powers base^1, base^3, ..., base^(2^windowBits - 1) in Montgomery form
+    void precomputeOddPowers(const Number& base, int windowBits, Number* table) const {
+        table[0] = base;
+        if (windowBits == 1) return;
+        Number baseSquared = square(base);
+        for (int i = 1; i < (1 << (windowBits - 1)); ++i) {
+            table[i] = multiply(table[i - 1], baseSquared); // Next odd power
+        }
+    }
+    // Sliding-window exponentiation over precomputed odd powers of the base, in Montgomery form.
+    // Exponent bits are read directly from the limbs, most significant first.
+    Number powWithTable(const Number* table, int windowBits, const Number& exponent) const {
+        Number result = rModN; // 1 in Montgomery form
+        bool started = false; // Squaring one is skipped until the first window is applied
+        int bit = exponent.bitLength() - 1;
+        while (bit >= 0) {
+            if (!exponent.testBit(bit)) {
+                if (started) result = square(result);
+                --bit;
+                continue;
+            }
+            // Longest window of at most windowBits bits that ends in a set bit
+            int low = bit - windowBits + 1 > 0 ? bit - windowBits + 1 : 0;
+            while (!exponent.testBit(low)) ++low;
+            int value = 0;
+            for (int i = bit; i >= low; --i) {
+                value = (value << 1) | exponent.testBit(i);
+                if (started) result = square(result);
+            }
+            result = started ? multiply(result, table[value >> 1]) : table[value >> 1];
+            started = true;
+            bit = low - 1;
+        }
+        return result;
+    }
+    // Window width that minimises multiplications for an exponent of the given size
+    static int chooseWindowBits(int exponentBits) {
+        if (exponentBits > 671) return 6;
+        if (exponentBits > 239) return 5;
+        if (exponentBits > 79) return 4;
+        if (exponentBits > 23) return 3;
+        return 2;
+    }
+    // Raise a Montgomery-form base to a plain exponent, returning Montgomery form.
+    // windowBits selects the sliding-window width (1 is plain binary), 0 picks one from the exponent size.
+    Number powMontgomery(const Number& base, const Number& exponent, int windowBits = 0) const {
+        if (constantTime) {
+            Number result = rModN; // 1 in Montgomery form
+            // Square and always multiply over the full width, selecting the product with a mask
+            for (int bit = Bits - 1; bit >= 0; --bit) {
+                result = square(result);
+                Number product = multiply(result, base);
+                uint64_t mask = 0 - (uint64_t)exponent.testBit(bit);
+                for (int i = 0; i < limb_count; ++i) {
+                    result.limbs[i] = (product.limbs[i] & mask) | (result.limbs[i] & ~mask);
+                }
+            }
+            return result;
+        }
+        if (windowBits <= 0) windowBits = chooseWindowBits(exponent.bitLength());
+        if (windowBits > max_window_bits) windowBits = max_window_bits;
+        array<Number, 1 << (max_window_bits - 1)> table; // Odd powers of the base
+        precomputeOddPowers(base, windowBits, table.data());
+        return powWithTable(table.data(), windowBits, exponent);
+    }
+    // Compute base^exponent mod n for plain (non-Montgomery) values
+    Number modPow(const Number& base, const Number& exponent) const {
+        return fromMontgomery(powMontgomery(toMontgomery(base), exponent));
+    }
+};
+
+// Barrett reduction for a fixed modulus n of k significant limbs.
+// mu = floor(2^(128k) / n) is computed once, after which reducing a value below
+// 2^(128k) costs two multiplications and at most two subtractions instead of a division.
+template <int Bits>
+class BarrettContext {
+public:
+    typedef FixedLargeNumber<Bits> Number;
+    static const int limb_count = Number::limb_count;
+private:
+    Number modulus; // The modulus n
+    int k; // Significant limbs in n
+    array<uint64_t, limb_count + 1> mu; // floor(2^(128k) / n), at most k + 1 limbs
+public:
+    // Constructor precomputing mu. The modulus must be non-zero.
+    BarrettContext(const Number& n) : modulus(n) {
+        k = significantLimbs(n.limbs.data(), limb_count);
+        uint64_t power[2 * limb_count + 1] = {}; // 2^(128k)
+        power[2 * k] = 1;
+        uint64_t quotient[2 * limb_count + 1];
+        uint64_t scratch[3 * limb_count + 2];
+        divideLimbs(power, 2 * k + 1, n.limbs.data(), k, quotient, nullptr, scratch);
+        for (int i = 0; i <= limb_count; ++i) mu[i] = i <= k ? quotient[i] : 0;
+    }
+    // The modulus this context was built for
+    const Number& getModulus() const {
+        return modulus;
+    }
+    // Reduce x (below 2^(128k), for example a product of two residues) modulo n
+    Number reduce(const FixedLargeNumber<2 * Bits>& x) const {
+        const uint64_t* xl = x.limbs.data();
+        // q3 = floor(floor(x / 2^(64(k-1))) * mu / 2^(64(k+1)))
+        uint64_t product[2 * limb_count + 2];
+        multiplyLimbs(xl + (k - 1), k + 1, mu.data(), k + 1, product);
+        const uint64_t* q3 = product + (k + 1); // k + 1 limbs
+
+        // r = (x - q3 * n) mod 2^(64(k+1)), which lies in [0, 3n); only the low k + 1
+        // limbs of q3 * n are needed
+        uint64_t qn[limb_count + 1] = {};
+        for (int i = 0; i <= k; ++i) {
+            uint64_t carry = 0;
+            for (int j = 0; j < k && i + j <= k; ++j) {
+                unsigned __int128 t = (unsigned __int128)q3[i] * modulus.limbs[j] + qn[i + j] + carry;
+                qn[i + j] = (uint64_t)t;
+                carry = (uint64_t)(t >> 64);
+            }
+            if (i + k <= k) qn[i + k] += carry;
+        }
+        uint64_t r[limb_count + 1];
+        uint64_t borrow = 0;
+        for (int i = 0; i <= k; ++i) {
+            unsigned __int128 diff = (unsigned __int128)xl[i] - qn[i] - borrow;
+            r[i] = (uint64_t)diff;
+            borrow = (uint64_t)(diff >> 64) & 1;
+        }
+        while (true) { // At most two corrections
+            uint64_t trial[limb_count + 1];
+            borrow = 0;
+            for (int i = 0; i <= k; ++i) {
+                unsigned __int128 diff = (unsigned __int128)r[i] - (i < k ? modulus.limbs[i] : 0) - borrow;
+                trial[i] = (uint64_t)diff;
+                borrow = (uint64_t)(diff >> 64) & 1;
+            }
+            if (borrow) break; // r < n
+            for (int i = 0; i <= k; ++i) r[i] = trial[i];
+        }
+        Number result;
+        for (int i = 0; i < k; ++i) result.limbs[i] = r[i];
+        return result;
+    }
+    // (a * b) mod n for residues a, b below n
+    Number multiply(const Number& a, const Number& b) const {
+        return reduce(a * b);
+    }
+    // (a * a) mod n for a residue a below n
+    Number square(const Number& a) const {
+        return reduce(a.square());
+    }
+};
+
+// Precomputed odd powers of one base for a fixed modulus.
+// Repeated exponentiations of the same base (for example a witness reused across a
+// loop) skip the table setup and go straight to the sliding-window pass.
+template <int Bits>
+class FixedBasePowTable {
+public:
+    typedef FixedLargeNumber<Bits> Number;
+private:
+    const MontgomeryContext<Bits>& context; // Context for the modulus, must outlive the table
+    int windowBits; // Sliding-window width used by every pow call
+    array<Number, 1 << (MontgomeryContext<Bits>::max_window_bits - 1)> table; // Odd powers in Montgomery form
+public:
+    // Constructor building the table for base (a plain residue). windowBits 0 sizes it for full-width exponents.
+    FixedBasePowTable(const MontgomeryContext<Bits>& context, const Number& base, int windowBits = 0)
+        : context(context), windowBits(windowBits) {
+        if (this->windowBits <= 0) this->windowBits = MontgomeryContext<Bits>::chooseWindowBits(Bits);
+        if (this->windowBits > MontgomeryContext<Bits>::max_window_bits) this->windowBits = MontgomeryContext<Bits>::max_window_bits;
+        context.precomputeOddPowers(context.toMontgomery(base), this->windowBits, table.data());
+    }
+    // base^exponent in Montgomery form
+    Number powMontgomery(const Number& exponent) const {
+        return context.powWithTable(table.data(), windowBits, exponent);
+    }
+    // base^exponent mod n as a plain residue
+    Number modPow(const Number& exponent) const {
+        return context.fromMontgomery(powMontgomery(exponent));
+    }
+};
+
+// Batched Miller-Rabin. Candidates are tested batch_lanes at a time, one witness round per
+// lane of montgomeryMultiplyBatch, each lane stepping through its own sliding-window
+// exponentiation a^d mod n and squarings. A candidate's first round runs alone; only if it
+// passes are its remaining rounds queued, and they run side by side in several lanes. As soon
+// as a witness proves a candidate composite, every lane working on it drops it and takes the
+// next round or candidate, so the batch stays full. The rounds are those of isPrime(rounds, 1),
+// with witnesses drawn the same way.
+template <int Bits>
+class MillerRabinBatch {
+public:
+    typedef FixedLargeNumber<Bits> Number;
+    static const int digits = batchDigits(Bits); // 28-bit digits per number
+
+    // Constructor for a test with the given number of rounds, multiplying at the given level
+    MillerRabinBatch(int rounds = 5, SimdLevel level = detectSimdLevel())
+        : rounds(rounds), level(level), x(digits * batch_lanes), operand(digits * batch_lanes),
+          modulus(digits * batch_lanes), window(2 * digits * batch_lanes) {}
+
+    // Test every candidate; the result holds true for the probable primes
+    vector<bool> test(span<const Number> candidates) {
+        this->candidates = candidates;
+        result.assign(candidates.size(), false);
+        decided.assign(candidates.size(), false);
+        states.clear();
+        states.resize(candidates.size());
+        followUps.clear();
+        nextCandidate = 0;
+        for (int lane = 0; lane < batch_lanes; ++lane) {
+            lanes[lane] = Lane();
+            lanes[lane].table.resize((1 << (max_window_bits - 1)) * digits);
+            lanes[lane].baseSquared.resize(digits);
+            nPrime[lane] = 0;
+            plan(lane);
+        }
+        while (true) {
+            bool active = false;
+            for (int lane = 0; lane < batch_lanes; ++lane) { // Gather each lane's multiplicand
+                const Lane& state = lanes[lane];
+                if (state.operation == Operation::None) continue;
+                active = true;
+                for (int j = 0; j < digits; ++j) {
+                    operand[j * batch_lanes + lane] = state.operation == Operation::Square
+                                                      ? x[j * batch_lanes + lane] : state.multiplicand[j];
+                }
+            }
+            if (!active) break;
+            montgomeryMultiplyBatch(x.data(), operand.data(), modulus.data(), nPrime, digits, window.data(), x.data(), level);
+            for (int lane = 0; lane < batch_lanes; ++lane) {
+                if (lanes[lane].operation != Operation::None) plan(lane);
+            }
+        }
+        return result;
+    }
+private:
+    static const int max_window_bits = 5; // Largest sliding window, 16 odd powers per lane
+
+    enum class Operation { None, Square, Multiply };
+    enum class Phase { TableStart, Table, Exponent, Squaring };
+
+    // What every round of one candidate shares
+    struct Candidate {
+        Number d; // n - 1 = 2^s * d
+        int s = 0;
+        int windowBits = 1; // Sliding-window width for d
+        Number rModN; // R mod n, which is 1 in Montgomery form
+        vector<uint64_t> n, one, minusOne; // n, and 1 and n - 1 in Montgomery form, as digits
+        uint64_t nPrime = 0; // -n^-1 mod 2^28
+        int roundsPassed = 0;
+        int lanesWorking = 0; // Lanes running a round of this candidate
+    };
+
+    // Progress of the round running in one lane
+    struct Lane {
+        int candidate = -1; // Index of the candidate in this lane, -1 when idle
+        Phase phase = Phase::TableStart;
+        int tableSize = 0, tableFilled = 0; // Odd powers a, a^3, a^5, ... of the witness
+        vector<uint64_t> table; // Odd powers as digits, one after another
+        vector<uint64_t> baseSquared; // a^2 as digits, the step between odd powers
+        int bit = 0; // Next exponent bit to process
+        int squaresLeft = 0; // Squarings before the pending window multiply
+        int windowSlot = -1; // Table entry for the pending window multiply, -1 for none
+        int squaringsLeft = 0; // Squarings left to find n - 1
+        Operation operation = Operation::None; // Product this lane takes part in next
+        const uint64_t* multiplicand = nullptr; // Digits x is multiplied by
+    };
+
+    int rounds;
+    SimdLevel level;
+    span<const Number> candidates;
+    vector<bool> result; // Verdict per candidate
+    vector<bool> decided; // Whether the verdict is final
+    vector<unique_ptr<Candidate>> states; // Shared state of candidates in progress
+    deque<int> followUps; // Rounds still to run, one entry per round, for candidates that passed their first
+    size_t nextCandidate = 0; // Next candidate not yet started
+    Lane lanes[batch_lanes];
+    vector<uint64_t> x; // Current power of each lane, digit-major
+    vector<uint64_t> operand; // Multiplicand of each lane for the next product
+    vector<uint64_t> modulus; // Each lane's n
+    uint64_t nPrime[batch_lanes];
+    vector<uint64_t> window; // Scratch for montgomeryMultiplyBatch
+
+    // Split a number into normalized 28-bit digits
+    static void toDigits(const Number& value, uint64_t* out) {
+        for (int j = 0; j < digits; ++j) {
+            int bit = j * batch_digit_bits;
+            uint64_t digit = 0;
+            if (bit / 64 < Bits / 64) digit = value.limb(bit / 64) >> (bit % 64);
+            if (bit % 64 > 64 - batch_digit_bits && bit / 64 + 1 < Bits / 64) {
+                digit |= value.limb(bit / 64 + 1) << (64 - bit % 64); // Digit straddles two limbs
+            }
+            out[j] = digit & batch_digit_mask;
+        }
+    }
+    // Copy digits into the lane's column of x
+    void setX(int lane, const uint64_t* value) {
+        for (int j = 0; j < digits; ++j) x[j * batch_lanes + lane] = value[j];
+    }
+    // Copy the lane's column of x out as digits
+    void getX(int lane, uint64_t* value) const {
+        for (int j = 0; j < digits; ++j) value[j] = x[j * batch_lanes + lane];
+    }
+    // Whether two digit arrays are equal
+    static bool sameDigits(const uint64_t* a, const uint64_t* b) {
+        for (int j = 0; j < digits; ++j) {
+            if (a[j] != b[j]) return false;
+        }
+        return true;
+    }
+    // Whether the lane's x, which is below 2n, equals value (below n) modulo n
+    bool xEquals(int lane, const uint64_t* value) const {
+        const uint64_t* n = states[lanes[lane].candidate]->n.data();
+        uint64_t reduced[digits];
+        getX(lane, reduced);
+        int j = digits - 1;
+        while (j > 0 && reduced[j] == n[j]) --j;
+        if (reduced[j] >= n[j]) { // x >= n: subtract n once
+            int64_t borrow = 0;
+            for (int k = 0; k < digits; ++k) {
+                int64_t digit = (int64_t)reduced[k] - (int64_t)n[k] - borrow;
+                borrow = digit < 0;
+                reduced[k] = (uint64_t)digit & batch_digit_mask;
+            }
+        }
+        return sameDigits(reduced, value);
+    }
+    // The odd exponent window d[top..low] with low the lowest set bit at most windowBits below top
+    static int windowAt(const Number& d, int top, int windowBits, int& low) {
+        low = max(top - windowBits + 1, 0);
+        while (!d.testBit(low)) ++low;
+        int value = 0;
+        for (int i = top; i >= low; --i) value = 2 * value + d.testBit(i);
+        return value;
+    }
+    // Set up the shared state of candidate index; returns false for candidates decided on the spot
+    bool load(size_t index) {
+        const Number& n = candidates[index];
+        if (n.isEven() || n.isOne()) { // Composite, or one
+            decided[index] = true;
+            return false;
+        }
+        if (n == Number(3)) { // Smallest odd prime with no valid witness range
+            result[index] = decided[index] = true;
+            return false;
+        }
+        unique_ptr<Candidate> state(new Candidate());
+        state->d = n - Number(1);
+        while (state->d.isEven()) {
+            state->d.divideByTwo();
+            state->s++;
+        }
+        state->windowBits = MontgomeryContext<Bits>::chooseWindowBits(state->d.bitLength());
+        if (state->windowBits > max_window_bits) state->windowBits = max_window_bits;
+        FixedLargeNumber<2 * Bits> r; // R = 2^(28 * digits)
+        r.setLimb(batch_digit_bits * digits / 64, 1ULL << (batch_digit_bits * digits % 64));
+        state->rModN = r.mod(n);
+        state->n.resize(digits);
+        state->one.resize(digits);
+        state->minusOne.resize(digits);
+        toDigits(n, state->n.data());
+        toDigits(state->rModN, state->one.data());
+        toDigits(n - state->rModN, state->minusOne.data());
+        uint64_t inverse = n.limb(0); // n^-1 mod 2^64 by Newton's iteration, 3 bits to start
+        for (int i = 0; i < 5; ++i) inverse *= 2 - n.limb(0) * inverse;
+        state->nPrime = (0 - inverse) & batch_digit_mask;
+        states[index] = move(state);
+        return true;
+    }
+    // Start a round of candidate index in the lane; returns false when its witness is 0 or 1,
+    // which passes without any products
+    bool startRound(int lane, int index) {
+        const Number& n = candidates[index];
+        Candidate& shared = *states[index];
+        Number witness;
+        witness.generateRandom(); // Generate random number
+        witness = witness.mod(n); // Reduce it modulo n
+        if (witness.isZero() || witness.isOne()) return false; // Skip if a is 0 or 1
+
+        Lane& state = lanes[lane];
+        state.candidate = index;
+        shared.lanesWorking++;
+        toDigits((witness * shared.rModN).mod(n), state.table.data()); // a in Montgomery form
+        setX(lane, state.table.data());
+        for (int j = 0; j < digits; ++j) modulus[j * batch_lanes + lane] = shared.n[j];
+        nPrime[lane] = shared.nPrime;
+        state.tableSize = 1 << (shared.windowBits - 1);
+        state.tableFilled = 1;
+        state.phase = Phase::TableStart;
+        return true;
+    }
+    // Give the lane the next round to run: queued rounds first, then a new candidate.
+    // Returns false when there is no work left.
+    bool assign(int lane) {
+        while (!followUps.empty()) {
+            int index = followUps.front();
+            followUps.pop_front();
+            if (decided[index]) continue; // Rejected by another round meanwhile
+            if (startRound(lane, index)) return true;
+            passRound(index);
+        }
+        while (nextCandidate < candidates.size()) {
+            int index = (int)nextCandidate++;
+            if (!load(index)) continue;
+            if (startRound(lane, index)) return true;
+            passRound(index);
+            if (!followUps.empty()) return assign(lane);
+        }
+        return false;
+    }
+    // Take the lane off its candidate, freeing the shared state once the candidate is decided
+    void release(int lane) {
+        int index = lanes[lane].candidate;
+        lanes[lane].candidate = -1;
+        if (--states[index]->lanesWorking == 0 && decided[index]) states[index].reset();
+    }
+    // A witness round of candidate index did not prove it composite
+    void passRound(int index) {
+        Candidate& shared = *states[index];
+        if (++shared.roundsPassed == rounds) { // n is probably prime
+            result[index] = decided[index] = true;
+            if (shared.lanesWorking == 0) states[index].reset();
+        } else if (shared.roundsPassed == 1) {
+            for (int i = 1; i < rounds; ++i) followUps.push_back(index); // Run the rest side by side
+        }
+    }
+    // Decide the lane's next product after its last one, moving on to another round or
+    // candidate when the current round is settled
+    void plan(int lane) {
+        Lane& state = lanes[lane];
+        while (true) {
+            if (state.candidate >= 0 && decided[state.candidate]) release(lane); // Proved composite elsewhere
+            if (state.candidate < 0 && !assign(lane)) {
+                state.operation = Operation::None;
+                return;
+            }
+            const Candidate& shared = *states[state.candidate];
+            if (state.phase == Phase::TableStart) { // x = a
+                state.phase = Phase::Table;
+                if (state.tableSize > 1) {
+                    state.operation = Operation::Square; // a^2, the step between odd powers
+                    return;
+                }
+            } else if (state.phase == Phase::Table) { // x = a^2 or the next odd power
+                if (state.tableFilled == 1) {
+                    getX(lane, state.baseSquared.data());
+                    setX(lane, state.table.data());
+                } else {
+                    getX(lane, state.table.data() + (state.tableFilled - 1) * digits);
+                }
+                if (state.tableFilled < state.tableSize) {
+                    state.tableFilled++;
+                    state.operation = Operation::Multiply;
+                    state.multiplicand = state.baseSquared.data();
+                    return;
+                }
+            }
+            if (state.phase == Phase::Table) { // Table done: x = the first window of d
+                int low;
+                int value = windowAt(shared.d, shared.d.bitLength() - 1, shared.windowBits, low);
+                setX(lane, state.table.data() + (value - 1) / 2 * digits);
+                state.bit = low - 1;
+                state.squaresLeft = 0;
+                state.windowSlot = -1;
+                state.phase = Phase::Exponent;
+            }
+            if (state.phase == Phase::Exponent) {
+                if (state.squaresLeft > 0) {
+                    state.squaresLeft--;
+                    state.operation = Operation::Square;
+                    return;
+                }
+                if (state.windowSlot >= 0) {
+                    state.operation = Operation::Multiply;
+                    state.multiplicand = state.table.data() + state.windowSlot * digits;
+                    state.windowSlot = -1;
+                    return;
+                }
+                if (state.bit >= 0) {
+                    if (!shared.d.testBit(state.bit)) { // Zero bit: square alone
+                        state.bit--;
+                        state.operation = Operation::Square;
+                        return;
+                    }
+                    int low;
+                    int value = windowAt(shared.d, state.bit, shared.windowBits, low);
+                    state.squaresLeft = state.bit - low + 1;
+                    state.windowSlot = (value - 1) / 2;
+                    state.bit = low - 1;
+                    continue;
+                }
+                if (xEquals(lane, shared.one.data()) || xEquals(lane, shared.minusOne.data())) { // x = a^d mod n
+                    int index = state.candidate;
+                    release(lane);
+                    passRound(index);
+                    continue;
+                }
+                state.phase = Phase::Squaring;
+                state.squaringsLeft = shared.s - 1;
+            } else { // After a squaring
+                state.squaringsLeft--;
+                if (xEquals(lane, shared.minusOne.data())) {
+                    int index = state.candidate;
+                    release(lane);
+                    passRound(index);
+                    continue;
+                }
+                if (xEquals(lane, shared.one.data())) state.squaringsLeft = 0; // Stays 1 from here on
+            }
+            if (state.squaringsLeft <= 0) { // a is a witness, n is composite
+                decided[state.candidate] = true;
+                release(lane);
+                continue;
+            }
+            state.operation = Operation::Square;
+            return;
+        }
+    }
+};
+
+// Test many candidates at once with MillerRabinBatch; the result holds true for the probable primes
+template <int Bits>
+vector<bool> isPrimeBatch(span<const FixedLargeNumber<Bits>> candidates, int rounds = 5) {
+    MillerRabinBatch<Bits> batch(rounds);
+    return batch.test(candidates);
+}
+
+// The first count odd primes (3, 5, 7, ...), computed once with a sieve of Eratosthenes
+const vector<uint32_t>& smallOddPrimes(int count = 2048);
+
+// Prime search pipeline: random odd starting points are drawn in batches, the window
+// n, n + 2, n + 4, ... after each one is sieved with stored residues modulo the small
+// primes, and only the survivors pay for a Miller-Rabin test. Batches run on a WorkerPool.
+template <int Bits>
+class PrimeSearch {
+public:
+    typedef FixedLargeNumber<Bits> Number;
+private:
+    WorkerPool pool; // Workers that each sieve and test their own batches
+    const vector<uint32_t>& primes; // Small odd primes used for trial division
+    int windowSize; // Candidates sieved after each random starting point
+    atomic<long long> candidates; // Odd candidates examined
+    atomic<long long> survivors; // Candidates that passed the sieve and were sent to Miller-Rabin
+
+    // State shared by the workers of one findPrimes call. Candidate k of window w sits at
+    // position (w << 32) | k, and the result is the count primes with the lowest positions,
+    // so it does not depend on which worker gets which window or how fast they run.
+    struct Search {
+        uint64_t stream; // Random stream of window 0; window w draws from stream + w
+        int count; // Primes wanted
+        atomic<long long> nextWindow{0}; // Next window to hand out
+        atomic<uint64_t> cutoff{UINT64_MAX}; // Position of the count-th lowest prime found so far
+        mutex lock; // Guards found
+        vector<pair<uint64_t, Number>> found; // Lowest primes found so far, with their positions
+    };
+
+    // Keep found sorted by position and no longer than count
+    static void trimFound(Search& search) {
+        sort(search.found.begin(), search.found.end(),
+             [](const pair<uint64_t, Number>& a, const pair<uint64_t, Number>& b) { return a.first < b.first; });
+        if ((int)search.found.size() > search.count) search.found.resize(search.count);
+    }
+    // Sieve window w and record the primes it contains, stopping once every later candidate
+    // lies past the cutoff
+    void searchWindow(long long w, Search& search) {
+        setThreadRandomStream(search.stream + w); // Same start and witnesses on any worker
+        Number start;
+        start.generateRandom(); // Window starting point
+        start.setLimb(0, start.limb(0) | 1);
+        vector<uint32_t> residues(primes.size());
+        for (size_t j = 0; j < primes.size(); ++j) {
+            residues[j] = (uint32_t)start.modSmall(primes[j]); // Stored once per window
+        }
+        Number candidate = start;
+        for (int k = 0; k < windowSize; ++k) {
+            uint64_t position = ((uint64_t)w << 32) | k;
+            if (position > search.cutoff.load(memory_order_relaxed)) break; // Enough lower primes already
+            bool divisible = false; // Whether candidate = start + 2k has a small factor
+            for (size_t j = 0; j < primes.size(); ++j) {
+                if (residues[j] == 0) divisible = true;
+                residues[j] += 2; // Step the residue to the next odd candidate
+                if (residues[j] >= primes[j]) residues[j] -= primes[j];
+            }
+            candidates++;
+            if (!divisible) {
+                survivors++;
+                if (candidate.isPrime()) {
+                    lock_guard<mutex> guard(search.lock);
+                    search.found.emplace_back(position, candidate);
+                    if ((int)search.found.size() >= search.count) {
+                        trimFound(search);
+                        search.cutoff = search.found.back().first;
+                    }
+                }
+            }
+            candidate = candidate + Number(2);
+        }
+    }
+public:
+    // Constructor creating the worker pool and loading the small-prime table
+    PrimeSearch(int threads, int sieveSize = 2048, int windowSize = 4096)
+        : pool(threads), primes(smallOddPrimes(sieveSize)), windowSize(windowSize), candidates(0), survivors(0) {}
+
+    // Find count probable primes of full Bits width. After seedThreadRandom the result is the
+    // same for any number of threads.
+    vector<Number> findPrimes(int count) {
+        if (count <= 0) return {};
+        Search search;
+        search.stream = threadRandom().next(); // Drawn by the caller, so a seeded caller gets the same windows
+        search.count = count;
+        pool.run([&](int) {
+            long long w;
+            while (((uint64_t)(w = search.nextWindow++) << 32) <= search.cutoff.load(memory_order_relaxed)) {
+                searchWindow(w, search);
+            }
+        });
+        trimFound(search);
+        vector<Number> result;
+        for (const pair<uint64_t, Number>& prime : search.found) result.push_back(prime.second);
+        return result;
+    }
+    // Odd candidates examined so far
+    long long candidatesExamined() const {
+        return candidates.load();
+    }
+    // Candidates that survived the sieve and were tested with Miller-Rabin
+    long long candidatesTested() const {
+        return survivors.load();
+    }
+};
+
+// Common fixed widths
+typedef FixedLargeNumber<1024> LargeNumber1024;
+typedef FixedLargeNumber<2048> LargeNumber2048;
+typedef FixedLargeNumber<4096> LargeNumber4096;
+
+// isPrimeBatch for list numbers: candidates are grouped by width and each group is tested
+// as LargeNumber1024, 2048 or 4096 copies; wider ones fall back to the list isPrime()
+vector<bool> isPrimeBatch(span<const LargeNumber> candidates, int rounds = 5);
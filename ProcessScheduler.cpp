@@ -0,0 +1,56 @@
+// Out-of-line definitions for ProcessScheduler.h
+#include "ProcessScheduler.h"
+#include <sys/resource.h>
+using namespace std;
+
+// Function to get the console sink shared by every scheduler that has not been given one
+EventSink& consoleEventSink() {
+    static ConsoleEventSink sink(cout);
+    return sink;
+}
+
+// Function to get the shared sink that discards events
+EventSink& nullEventSink() {
+    static NullEventSink sink;
+    return sink;
+}
+
+// Function to open a trace of either format, choosing the binary reader when the file
+// starts with the trace magic
+unique_ptr<TraceReader> openTrace(const string& path) {
+    char magic[sizeof(trace_magic)] = {};
+    if (FILE* file = fopen(path.c_str(), "rb")) {
+        size_t got = fread(magic, 1, sizeof(magic), file);
+        fclose(file);
+        if (got == sizeof(magic) && memcmp(magic, trace_magic, sizeof(magic)) == 0) {
+            return make_unique<BinaryTraceReader>(path);
+        }
+    }
+    return make_unique<CsvTraceReader>(path);
+}
+
+// Function to convert a CSV trace into a binary one; returns the number of records, or -1
+// if either file could not be opened
+long long convertCsvTrace(const string& csvPath, const string& binaryPath) {
+    CsvTraceReader reader(csvPath);
+    BinaryTraceWriter writer(binaryPath);
+    if (!reader.isOpen() || !writer.isOpen()) return -1;
+    ProcessSpec record{0, 0};
+    while (reader.next(record)) {
+        writer.write(record);
+    }
+    return reader.recordCount();
+}
+
+// Function to get the peak resident set size of this process, in kilobytes. Reads VmHWM,
+// which starts again at exec; ru_maxrss would carry over the parent's peak
+long peakResidentKilobytes() {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return atol(line.c_str() + 6);  // "VmHWM:  1234 kB"
+    }
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;  // Kilobytes on Linux
+}
@@ -0,0 +1,1613 @@
+// Process scheduling classes for assignment 1, question 1: the round-robin schedulers,
+// scheduling policies, workload traces, event sinks and metrics
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <new>
+#include <span>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <algorithm>
+#include <queue>
+#include <functional>
+#include <deque>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <cmath>
+#include <array>
+using namespace std;
+
+class Process {
+public:
+    int process_id; // Unique ID of the process
+    int execution_time; // Total time required for the process to complete
+    int remaining_time; // Time left for the process to complete
+    int priority; // Scheduling priority, 0 is the most urgent; multilevel feedback moves it
+    int arrival_time; // Time at which the process enters the system
+    int quantum; // Time slice for this process, 0 to use the policy's default
+    long long ready_time; // Time at which the process last joined a ready queue
+    long long first_run_time; // Time at which the process was first dispatched, -1 until then
+    int dispatches; // Quanta the process has been given so far
+    long long cpu_time; // CPU time the process has received so far
+    Process* next; // Pointer to the next process in the circular list
+
+    // Constructor
+    Process(int id, int time, int priority = 0, int arrival = 0, int quantum = 0)
+        : process_id(id), execution_time(time), remaining_time(time), priority(priority),
+          arrival_time(arrival), quantum(quantum), ready_time(arrival), first_run_time(-1),
+          dispatches(0), cpu_time(0), next(nullptr) {}
+};
+
+// Arrival record for bulk admission: the ID and execution time of one process, plus
+// the fields used by the scheduling policies
+struct ProcessSpec {
+    int process_id;
+    int execution_time;
+    int priority = 0;
+    int arrival_time = 0;
+    int quantum = 0;
+};
+
+// Completion record: when a process finished, by cycle number and by total CPU time used
+struct CompletionEvent {
+    int process_id;
+    int cycle;              // Cycle in which the process completed
+    long long finish_time;  // CPU time elapsed since the scheduler was created
+};
+
+// Slab allocator for Process nodes. Processes are carved out of slabs of
+// process_slab_size nodes and returned to a free list when they are released,
+// so admitting and completing processes does not go through malloc/free.
+const int process_slab_size = 1024; // Processes per slab
+
+class ProcessPool {
+private:
+    vector<Process*> slabs; // Raw storage for every slab, freed by the destructor
+    Process* freeList;      // Released processes, linked through their next pointers
+
+public:
+    // Constructor
+    ProcessPool() : freeList(nullptr) {}
+
+    // Function to get a process node, growing the pool by one slab if the free list is empty
+    Process* acquire(int id, int time, int priority = 0, int arrival = 0, int quantum = 0) {
+        if (!freeList) {
+            Process* slab = static_cast<Process*>(::operator new(sizeof(Process) * process_slab_size));
+            slabs.push_back(slab);
+            for (int i = process_slab_size - 1; i >= 0; i--) {  // Thread the new slab onto the free list
+                slab[i].next = freeList;
+                freeList = &slab[i];
+            }
+        }
+        Process* process = freeList;  // Take the first free node
+        freeList = freeList->next;
+        return new (process) Process(id, time, priority, arrival, quantum);  // Construct it in place
+    }
+
+    // Function to return a process node to the free list
+    void release(Process* process) {
+        process->next = freeList;
+        freeList = process;
+    }
+
+    // Number of slabs allocated so far
+    int slabCount() const {
+        return (int)slabs.size();
+    }
+
+    // Destructor to free every slab, which also frees any node still in use
+    ~ProcessPool() {
+        for (Process* slab : slabs) {
+            ::operator delete(slab);
+        }
+    }
+};
+
+// Scheduler events. Schedulers report what they do to an EventSink instead of printing:
+// a run event for every slice handed out, then a preempt event if the process still has
+// time left or a complete event if it finished. Timestamps are CPU time since the
+// scheduler was created.
+enum class EventType { Run, Preempt, Complete };
+
+struct SchedulerEvent {
+    EventType type;
+    int cycle;
+    long long time;  // Start of the slice for Run, end of it otherwise
+    int process_id;
+    int value;       // Slice length for Run, remaining time otherwise
+};
+
+// Interface for consumers of scheduler events
+class EventSink {
+public:
+    virtual ~EventSink() {}
+
+    // Whether the sink wants the process list before and after every cycle; schedulers
+    // skip walking the list when it does not
+    virtual bool wantsSnapshots() const {
+        return false;
+    }
+
+    // Function called once at the start of every cycle
+    virtual void cycleStarted(int cycle) {
+        (void)cycle;
+    }
+
+    // Functions called to list the processes before (afterCycle false) or after a cycle
+    virtual void snapshotStarted(bool afterCycle) {
+        (void)afterCycle;
+    }
+    virtual void snapshotEntry(int process_id, int remaining_time) {
+        (void)process_id;
+        (void)remaining_time;
+    }
+    virtual void snapshotFinished() {}
+
+    // Function called for every run, preempt and complete event
+    virtual void record(const SchedulerEvent& event) = 0;
+
+    // Function called once at the end of every cycle
+    virtual void cycleFinished(int cycle) {
+        (void)cycle;
+    }
+};
+
+// Sink that discards every event, for benchmarks
+class NullEventSink : public EventSink {
+public:
+    void record(const SchedulerEvent&) override {}
+};
+
+// Sink that prints the human-readable cycle log: the process list before and after each
+// cycle, every process run, and the processes completed in the cycle (most recent first).
+// Lines end in '\n' rather than endl, so the stream is not flushed on every line.
+class ConsoleEventSink : public EventSink {
+private:
+    ostream& out;
+    vector<int> completed;  // IDs completed in the current cycle, in completion order
+    bool emptySnapshot;
+
+public:
+    // Constructor
+    ConsoleEventSink(ostream& out = cout) : out(out), emptySnapshot(true) {}
+
+    bool wantsSnapshots() const override {
+        return true;
+    }
+
+    void cycleStarted(int cycle) override {
+        out << "Cycle " << cycle << ":\n";
+    }
+
+    void snapshotStarted(bool afterCycle) override {
+        out << (afterCycle ? "After:  " : "Before: ");
+        emptySnapshot = true;
+    }
+
+    void snapshotEntry(int process_id, int remaining_time) override {
+        out << "P" << process_id << " (Remaining: " << remaining_time << ") ";
+        emptySnapshot = false;
+    }
+
+    void snapshotFinished() override {
+        out << (emptySnapshot ? "No processes in the system.\n" : "\n");
+    }
+
+    void record(const SchedulerEvent& event) override {
+        if (event.type == EventType::Run) {
+            out << "Running process P" << event.process_id << " for " << event.value << " units.\n";
+        } else if (event.type == EventType::Complete) {
+            completed.push_back(event.process_id);
+        }
+    }
+
+    void cycleFinished(int) override {
+        if (!completed.empty()) {
+            out << "Completed processes: ";
+            for (size_t i = completed.size(); i-- > 0;) {
+                out << "P" << completed[i];
+                if (i > 0) out << ", ";
+            }
+            out << "\n";
+            completed.clear();
+        }
+        out << "\n";
+    }
+};
+
+// Function to get the console sink shared by every scheduler that has not been given one
+EventSink& consoleEventSink();
+
+// Function to get a shared sink that discards events, the default of PolicyScheduler
+EventSink& nullEventSink();
+
+// Base of the file sinks: collects bytes in a large buffer and writes it out only when full
+class BufferedFileSink : public EventSink {
+private:
+    FILE* file;
+    vector<char> buffer;
+    size_t filled;
+
+protected:
+    // Function to append bytes to the buffer, writing it out first if they do not fit
+    void append(const char* bytes, size_t length) {
+        if (filled + length > buffer.size()) flush();
+        memcpy(buffer.data() + filled, bytes, length);
+        filled += length;
+    }
+
+public:
+    // Constructor; check isOpen() before use
+    BufferedFileSink(const string& path, size_t bufferSize = 1 << 20)
+        : file(fopen(path.c_str(), "wb")), buffer(bufferSize), filled(0) {}
+
+    BufferedFileSink(const BufferedFileSink&) = delete;
+    BufferedFileSink& operator=(const BufferedFileSink&) = delete;
+
+    // Whether the file could be created
+    bool isOpen() const {
+        return file != nullptr;
+    }
+
+    // Function to write out everything buffered so far
+    void flush() {
+        if (file && filled > 0) fwrite(buffer.data(), 1, filled, file);
+        filled = 0;
+    }
+
+    // Destructor; flushes and closes the file
+    ~BufferedFileSink() {
+        flush();
+        if (file) fclose(file);
+    }
+};
+
+// Sink that writes one CSV line per event: type,cycle,time,process_id,value
+class CsvEventSink : public BufferedFileSink {
+public:
+    // Constructor; writes the header line
+    CsvEventSink(const string& path) : BufferedFileSink(path) {
+        const char header[] = "type,cycle,time,process_id,value\n";
+        append(header, sizeof(header) - 1);
+    }
+
+    void record(const SchedulerEvent& event) override {
+        static const char* const names[] = {"run,", "preempt,", "complete,"};
+        char line[96];
+        size_t length = strlen(names[(int)event.type]);
+        memcpy(line, names[(int)event.type], length);
+        long long fields[4] = {event.cycle, event.time, event.process_id, event.value};
+        for (int i = 0; i < 4; i++) {  // Each number fits in 20 characters
+            length = to_chars(line + length, line + sizeof(line), fields[i]).ptr - line;
+            line[length++] = i < 3 ? ',' : '\n';
+        }
+        append(line, length);
+    }
+};
+
+// Sink that writes events in binary: the 8-byte magic "RREVENT1", then per event the type,
+// cycle, time (64-bit), process ID and value as little-endian integers, 24 bytes in all
+class BinaryEventSink : public BufferedFileSink {
+public:
+    // Constructor; writes the magic
+    BinaryEventSink(const string& path) : BufferedFileSink(path) {
+        append("RREVENT1", 8);
+    }
+
+    void record(const SchedulerEvent& event) override {
+        char bytes[24];
+        int32_t head[2] = {(int32_t)event.type, event.cycle};
+        int64_t time = event.time;
+        int32_t tail[2] = {event.process_id, event.value};
+        memcpy(bytes, head, 8);
+        memcpy(bytes + 8, &time, 8);
+        memcpy(bytes + 16, tail, 8);
+        append(bytes, sizeof(bytes));
+    }
+};
+
+// Distribution of a metric in fixed log-linear buckets, in the style of HDR histograms.
+// Values below 16 get a bucket each; above that, every power of two is split into 16
+// buckets, so a percentile is within 1/16 of the true value. The buckets are an inline
+// array, so adding a sample never allocates; count, total, min and max are kept exactly.
+const int histogram_sub_bucket_bits = 4;
+const int histogram_sub_buckets = 1 << histogram_sub_bucket_bits; // Buckets per power of two
+const int histogram_bucket_count = (64 - histogram_sub_bucket_bits + 1) * histogram_sub_buckets;
+
+class Histogram {
+private:
+    array<long long, histogram_bucket_count> buckets;  // Samples per bucket
+    long long samples;
+    long long total;
+    long long minimum, maximum;
+
+    // Function to find the bucket of a value; negative values share bucket 0
+    static int bucketOf(long long value) {
+        if (value < histogram_sub_buckets) return (int)::max(value, 0LL);
+        int exponent = 63 - __builtin_clzll((unsigned long long)value);  // Highest set bit, at least 4
+        int shift = exponent - histogram_sub_bucket_bits;
+        return (shift + 1) * histogram_sub_buckets + (int)(value >> shift) - histogram_sub_buckets;
+    }
+
+    // Function to get the middle of a bucket's range of values
+    static long long bucketMiddle(int bucket) {
+        if (bucket < histogram_sub_buckets) return bucket;
+        int shift = bucket / histogram_sub_buckets - 1;
+        unsigned long long lowest = (unsigned long long)(histogram_sub_buckets + bucket % histogram_sub_buckets) << shift;
+        return (long long)(lowest + ((1ULL << shift) - 1) / 2);
+    }
+
+public:
+    // Constructor
+    Histogram() {
+        clear();
+    }
+
+    // Function to add one sample
+    void add(long long value) {
+        if (samples == 0 || value < minimum) minimum = value;
+        if (samples == 0 || value > maximum) maximum = value;
+        buckets[bucketOf(value)]++;
+        samples++;
+        total += value;
+    }
+
+    // Number of samples
+    long long count() const {
+        return samples;
+    }
+
+    // Mean of the samples, 0 when there are none
+    double mean() const {
+        return samples == 0 ? 0 : (double)total / samples;
+    }
+
+    long long min() const {
+        return minimum;
+    }
+
+    long long max() const {
+        return maximum;
+    }
+
+    // Function to get the p-th percentile (nearest rank) to within its bucket, 0 when
+    // there are no samples; the answer is clamped to the exact min and max
+    long long percentile(double p) const {
+        if (samples == 0) return 0;
+        long long rank = ::max(1LL, (long long)ceil(p / 100 * samples));
+        long long seen = 0;
+        for (int bucket = 0; bucket < histogram_bucket_count; bucket++) {
+            seen += buckets[bucket];
+            if (seen >= rank) return ::min(::max(bucketMiddle(bucket), minimum), maximum);
+        }
+        return maximum;
+    }
+
+    // Function to drop every sample
+    void clear() {
+        buckets.fill(0);
+        samples = total = minimum = maximum = 0;
+    }
+
+    // Function to print count, mean, min, p50, p90, p99 and max on one line
+    void dump(ostream& out, const string& name) const {
+        out << name << ": count " << count() << ", mean " << mean() << ", min " << min() << ", p50 "
+            << percentile(50) << ", p90 " << percentile(90) << ", p99 " << percentile(99) << ", max " << max() << "\n";
+    }
+};
+
+// Metrics collected by ProcessScheduler. Per-process times are in CPU time units from
+// the moment the process was added; dispatch overhead is wall-clock time measured with
+// steady_clock around each cycle, not counting the event sink, which is timed separately.
+struct SchedulerStats {
+    Histogram turnaround;     // Admission to completion, per process
+    Histogram waiting;        // Turnaround minus execution time, per process
+    Histogram response;       // Admission to first dispatch, per process
+    Histogram queueLength;    // Processes in the queue at the start of each cycle
+    Histogram dispatchNanos;  // Average nanoseconds per dispatch, per cycle
+    Histogram sinkNanos;      // Average nanoseconds per dispatch spent in the event sink, per cycle
+    Histogram cycleContextSwitches;  // Context switches in each cycle
+    long long cycles = 0;
+    long long dispatches = 0;
+    long long contextSwitches = 0;  // Dispatches of a different process than the previous one
+
+    // Function to print every metric
+    void dump(ostream& out) const {
+        out << "cycles " << cycles << ", dispatches " << dispatches << ", context switches " << contextSwitches << "\n";
+        turnaround.dump(out, "turnaround");
+        waiting.dump(out, "waiting");
+        response.dump(out, "response");
+        queueLength.dump(out, "queue length");
+        dispatchNanos.dump(out, "ns per dispatch");
+        sinkNanos.dump(out, "sink ns per dispatch");
+        cycleContextSwitches.dump(out, "context switches per cycle");
+    }
+};
+
+// Class to manage the process scheduling and simulate the CPU execution cycles
+class ProcessScheduler {
+private:
+    Process* head;            
+    Process* tail;            // Last process in the circular list, so enqueue is O(1)
+    int processCount;         // Number of processes in the list
+    const int cpu_time_per_cycle = 3; // CPU time assigned to each process per cycle
+    ProcessPool pool;         // Owns the memory of every process node
+    long long elapsedTime;    // Total CPU time handed out so far
+    vector<CompletionEvent>* completionLog; // If set, runCycle records every completion here
+    EventSink* sink;          // Receives the events of every cycle
+    SchedulerStats metrics;   // Collected on every cycle
+    const Process* lastDispatched; // For counting context switches
+    vector<SchedulerEvent> cycleEvents; // Events of the running cycle, sent to the sink after timing it
+
+    // Function to list every process in the system to the sink
+    void snapshot(bool afterCycle) {
+        sink->snapshotStarted(afterCycle);
+        if (head) {
+            Process* current = head;
+            do {
+                sink->snapshotEntry(current->process_id, current->remaining_time);
+                current = current->next;
+            } while (current != head);
+        }
+        sink->snapshotFinished();
+    }
+
+public:
+    // Constructor 
+    ProcessScheduler() : head(nullptr), tail(nullptr), processCount(0), elapsedTime(0), completionLog(nullptr),
+                         sink(&consoleEventSink()), lastDispatched(nullptr) {}
+
+    // Metrics collected since construction or the last resetStats()
+    const SchedulerStats& stats() const {
+        return metrics;
+    }
+
+    // Function to clear the collected metrics
+    void resetStats() {
+        metrics = SchedulerStats();
+    }
+
+    // Function to send the scheduler's events to another sink (the console sink by default)
+    void setEventSink(EventSink& eventSink) {
+        sink = &eventSink;
+    }
+
+    // Function to make runCycle record each completion in the given log (nullptr to stop)
+    void setCompletionLog(vector<CompletionEvent>* log) {
+        completionLog = log;
+    }
+
+    // Function to add a new process to the circular list
+    void addProcess(int process_id, int execution_time) {
+        Process* newProcess = pool.acquire(process_id, execution_time);  // Take a process node from the pool
+        newProcess->ready_time = elapsedTime;  // Admission time, for the metrics
+        if (!head) {  // If the list is empty, make the new process the head and point it to itself
+            head = newProcess;
+        } else {  // Otherwise, insert the new process after the tail
+            tail->next = newProcess;
+        }
+        tail = newProcess;
+        newProcess->next = head; // Make the list circular
+        processCount++;
+    }
+
+    // Function to admit a batch of processes in order, linking them into the list in one pass
+    void addProcesses(span<const ProcessSpec> processes) {
+        for (const ProcessSpec& spec : processes) {
+            Process* newProcess = pool.acquire(spec.process_id, spec.execution_time);
+            newProcess->ready_time = elapsedTime;
+            if (!head) {
+                head = newProcess;
+            } else {
+                tail->next = newProcess;
+            }
+            tail = newProcess;
+            processCount++;
+        }
+        if (tail) {
+            tail->next = head; // Close the circle once for the whole batch
+        }
+    }
+
+    // Function to simulate a single CPU cycle where time is assigned to processes
+    void runCycle(int& cycleCount) {
+        if (!head) {  // If there are no processes, exit
+            return;
+        }
+        bool snapshots = sink->wantsSnapshots();
+        sink->cycleStarted(cycleCount);
+        if (snapshots) {
+            snapshot(false);  // The state of all processes before running this cycle
+        }
+
+        Process* current = head;       // Pointer to track the current process in the list
+        Process* prev = tail;          // Pointer to track the previous process (for deletion)
+        Process* completedHead = nullptr;  // Temporary list for completed processes
+        int visits = processCount;     // Every process present at the start of the cycle runs once
+        int dispatched = visits;
+        metrics.queueLength.add(visits);
+        long long switchesBefore = metrics.contextSwitches;
+        auto cycleStart = chrono::steady_clock::now();
+
+        // Loop through the circular list of processes and assign CPU time
+        while (visits-- > 0) {
+            // Report which process is running and for how much time
+            int slice = min(cpu_time_per_cycle, current->remaining_time);
+            cycleEvents.push_back({EventType::Run, cycleCount, elapsedTime, current->process_id, slice});
+            if (current->first_run_time < 0) {
+                current->first_run_time = elapsedTime;
+                metrics.response.add(elapsedTime - current->ready_time);
+            }
+            metrics.contextSwitches += current != lastDispatched;
+            lastDispatched = current;
+
+            // Reduce the remaining time of the current process
+            elapsedTime += slice;
+            current->remaining_time -= cpu_time_per_cycle;
+            Process* following = current->next;
+
+            // Check if the process has completed its execution
+            if (current->remaining_time <= 0) {
+                // Remove the process from the circular linked list
+                if (following == current) { // If it's the only process in the list
+                    head = nullptr; // Set head to null since there are no more processes
+                    tail = nullptr;
+                } else {
+                    prev->next = following;      // Skip over the current process
+                    if (current == head) {
+                        head = following;        // Move head to the next process
+                    }
+                    if (current == tail) {
+                        tail = prev;             // The previous process is the new tail
+                    }
+                }
+                processCount--;
+                cycleEvents.push_back({EventType::Complete, cycleCount, elapsedTime, current->process_id, 0});
+                metrics.turnaround.add(elapsedTime - current->ready_time);
+                metrics.waiting.add(elapsedTime - current->ready_time - current->execution_time);
+                lastDispatched = nullptr;  // The node may be reused by a later process
+                if (completionLog) {
+                    completionLog->push_back({current->process_id, cycleCount, elapsedTime});
+                }
+
+                // The node itself moves to the temporary list of completed processes
+                current->remaining_time = 0;
+                current->next = completedHead;
+                completedHead = current;
+            } else {
+                cycleEvents.push_back({EventType::Preempt, cycleCount, elapsedTime, current->process_id, current->remaining_time});
+                prev = current;  // Update prev to the current process
+            }
+            current = following;  // Move to the next process in the list
+        }
+        auto cycleEnd = chrono::steady_clock::now();
+        double cycleNanos = chrono::duration<double, nano>(cycleEnd - cycleStart).count();
+        metrics.dispatchNanos.add((long long)(cycleNanos / dispatched + 0.5));
+
+        // Hand the cycle's events to the sink outside the timed dispatch loop
+        for (const SchedulerEvent& event : cycleEvents) {
+            sink->record(event);
+        }
+        cycleEvents.clear();  // Keeps its capacity for the next cycle
+        double sinkNanos = chrono::duration<double, nano>(chrono::steady_clock::now() - cycleEnd).count();
+        metrics.sinkNanos.add((long long)(sinkNanos / dispatched + 0.5));
+        metrics.dispatches += dispatched;
+        metrics.cycles++;
+        metrics.cycleContextSwitches.add(metrics.contextSwitches - switchesBefore);
+
+        if (snapshots) {
+            snapshot(true);  // The state of processes after the cycle
+        }
+        sink->cycleFinished(cycleCount);
+        freeCompletedList(completedHead); // Return the completed processes to the pool
+        
+        cycleCount++;  // Increment the cycle counter
+    }
+
+    // Function to display the state of all processes in the system
+    void displayState() {
+        if (!head) {  // If there are no processes
+            cout << "No processes in the system." << endl;
+            return;
+        }
+
+        Process* current = head;
+        do {
+            cout << "P" << current->process_id << " (Remaining: " << current->remaining_time << ") ";  // Display remaining time of each process
+            current = current->next;
+        } while (current != head);
+        cout << endl;
+    }
+
+    // Function to return the completed process list to the pool
+    void freeCompletedList(Process* completedHead) {
+        while (completedHead) {
+            Process* temp = completedHead;  // Recycle each completed process node
+            completedHead = completedHead->next;
+            pool.release(temp);
+        }
+    }
+
+    // Function to simulate the entire scheduling process, running cycles until all processes are completed
+    void simulate() {
+        int cycleCount = 1;  // Initialize cycle counter
+        while (head) {       // Keep running cycles as long as there are processes
+            runCycle(cycleCount);
+        }
+    }
+
+    // Function to run every remaining process to completion without cycling through them.
+    // A process with r units left completes in cycle ceil(r / 3), and processes completing
+    // in the same cycle do so in list order, so a min-heap on (quanta, position), packed into
+    // one 64-bit key, yields the completions in exactly the order simulate() would, in
+    // O(N log N) instead of one visit per quantum. Finish times use a Fenwick tree counting
+    // the processes still alive ahead of each one. Cycles are numbered from 1, as in
+    // simulate(); nothing is printed and the metrics are not updated.
+    vector<CompletionEvent> fastForward() {
+        vector<CompletionEvent> events;
+        if (!head) {
+            return events;
+        }
+        events.reserve(processCount);
+
+        // Number the processes by position from the head and key each by its completion quanta
+        vector<Process*> byPosition;
+        vector<unsigned long long> keys;
+        byPosition.reserve(processCount);
+        keys.reserve(processCount);
+        Process* current = head;
+        do {
+            unsigned long long quanta = max(1, (current->remaining_time + cpu_time_per_cycle - 1) / cpu_time_per_cycle);
+            keys.push_back(quanta << 32 | byPosition.size());
+            byPosition.push_back(current);
+            current = current->next;
+        } while (current != head);
+        // Heapify all keys at once in O(N)
+        priority_queue<unsigned long long, vector<unsigned long long>, greater<unsigned long long>> completions(greater<unsigned long long>(), move(keys));
+
+        int total = (int)byPosition.size();
+        vector<int> alive(total + 1, 0);  // Fenwick tree over positions of unfinished processes
+        for (int i = 1; i <= total; i++) {
+            alive[i]++;
+            int parent = i + (i & -i);
+            if (parent <= total) alive[parent] += alive[i];
+        }
+
+        long long startTime = elapsedTime;
+        long long finishedWork = 0;  // CPU time of the processes completed in earlier cycles
+        long long cycleWork = 0;     // Final slices of the processes completed so far in this cycle
+        long long cycleFinishedWork = 0;  // Total CPU time of those processes
+        long long cycle = 0;
+        int aliveAtCycleStart = total;
+        int finished = 0;
+        while (!completions.empty()) {
+            long long quanta = (long long)(completions.top() >> 32);
+            int position = (int)(completions.top() & 0xffffffffu);
+            completions.pop();
+            if (quanta != cycle) {  // First completion of a later cycle
+                finishedWork += cycleFinishedWork;
+                cycleWork = 0;
+                cycleFinishedWork = 0;
+                cycle = quanta;
+                aliveAtCycleStart = total - finished;
+            }
+
+            int aheadStillRunning = 0;  // Unfinished processes before this one in the list
+            for (int i = position; i > 0; i -= i & -i) aheadStillRunning += alive[i];
+            for (int i = position + 1; i <= total; i += i & -i) alive[i]--;
+
+            Process* process = byPosition[position];
+            long long lastSlice = process->remaining_time - (cycle - 1) * cpu_time_per_cycle;
+            lastSlice = max(0LL, lastSlice);
+            cycleWork += lastSlice;
+            cycleFinishedWork += max(0, process->remaining_time);
+            long long finishTime = startTime + finishedWork
+                                   + (cycle - 1) * cpu_time_per_cycle * aliveAtCycleStart
+                                   + cycleWork + (long long)aheadStillRunning * cpu_time_per_cycle;
+            events.push_back({process->process_id, (int)cycle, finishTime});
+            finished++;
+        }
+        elapsedTime = events.back().finish_time;
+
+        for (Process* process : byPosition) {  // Return every node to the pool
+            pool.release(process);
+        }
+        head = nullptr;
+        tail = nullptr;
+        processCount = 0;
+        lastDispatched = nullptr;
+        return events;
+    }
+
+    // Destructor; the pool frees the memory of any remaining processes in the list
+    ~ProcessScheduler() {}
+};
+
+// Round-robin scheduler on a contiguous ring buffer instead of a linked list. IDs and
+// remaining times are stored as separate arrays (struct of arrays), so a cycle is a
+// linear scan that compacts the survivors in place. It prints the same output as
+// ProcessScheduler and can be used in its place.
+class RingProcessScheduler {
+private:
+    vector<int> ids;              // Process IDs, indexed by ring slot
+    vector<int> remaining;        // Remaining time, indexed by ring slot
+    size_t start;                 // Ring slot of the first process in round-robin order
+    size_t count;                 // Number of processes in the ring
+    const int cpu_time_per_cycle = 3; // CPU time assigned to each process per cycle
+    long long elapsedTime;        // Total CPU time handed out so far
+    EventSink* sink;              // Receives the events of every cycle
+
+    // Function to list every process in the system to the sink
+    void snapshot(bool afterCycle) {
+        sink->snapshotStarted(afterCycle);
+        for (size_t i = 0; i < count; i++) {
+            size_t slot = (start + i) & (ids.size() - 1);
+            sink->snapshotEntry(ids[slot], remaining[slot]);
+        }
+        sink->snapshotFinished();
+    }
+
+    // Function to double the ring capacity, unrolling the ring so it starts at slot 0
+    void grow() {
+        size_t capacity = ids.empty() ? 16 : ids.size() * 2;
+        vector<int> newIds(capacity), newRemaining(capacity);
+        for (size_t i = 0; i < count; i++) {
+            size_t slot = (start + i) & (ids.size() - 1);
+            newIds[i] = ids[slot];
+            newRemaining[i] = remaining[slot];
+        }
+        ids.swap(newIds);
+        remaining.swap(newRemaining);
+        start = 0;
+    }
+
+public:
+    // Constructor
+    RingProcessScheduler() : start(0), count(0), elapsedTime(0), sink(&consoleEventSink()) {}
+
+    // Function to send the scheduler's events to another sink (the console sink by default)
+    void setEventSink(EventSink& eventSink) {
+        sink = &eventSink;
+    }
+
+    // Function to add a new process at the end of the round-robin order
+    void addProcess(int process_id, int execution_time) {
+        if (count == ids.size()) {
+            grow();
+        }
+        size_t slot = (start + count) & (ids.size() - 1);
+        ids[slot] = process_id;
+        remaining[slot] = execution_time;
+        count++;
+    }
+
+    // Function to admit a batch of processes in order
+    void addProcesses(span<const ProcessSpec> processes) {
+        while (ids.size() < count + processes.size()) {
+            grow();
+        }
+        for (const ProcessSpec& spec : processes) {
+            size_t slot = (start + count) & (ids.size() - 1);
+            ids[slot] = spec.process_id;
+            remaining[slot] = spec.execution_time;
+            count++;
+        }
+    }
+
+    // Number of processes waiting to run
+    size_t size() const {
+        return count;
+    }
+
+    // Function to simulate a single CPU cycle where time is assigned to processes
+    void runCycle(int& cycleCount) {
+        if (count == 0) {  // If there are no processes, exit
+            return;
+        }
+        bool snapshots = sink->wantsSnapshots();
+        sink->cycleStarted(cycleCount);
+        if (snapshots) {
+            snapshot(false);
+        }
+
+        size_t mask = ids.size() - 1;
+        size_t kept = 0;             // Survivors are compacted to the front of the ring
+        for (size_t i = 0; i < count; i++) {
+            size_t slot = (start + i) & mask;
+            int slice = min(cpu_time_per_cycle, remaining[slot]);
+            sink->record({EventType::Run, cycleCount, elapsedTime, ids[slot], slice});
+            elapsedTime += slice;
+            remaining[slot] -= cpu_time_per_cycle;
+            if (remaining[slot] <= 0) {
+                sink->record({EventType::Complete, cycleCount, elapsedTime, ids[slot], 0});
+            } else {
+                sink->record({EventType::Preempt, cycleCount, elapsedTime, ids[slot], remaining[slot]});
+                size_t target = (start + kept) & mask;
+                ids[target] = ids[slot];
+                remaining[target] = remaining[slot];
+                kept++;
+            }
+        }
+        count = kept;
+
+        if (snapshots) {
+            snapshot(true);
+        }
+        sink->cycleFinished(cycleCount);
+        cycleCount++;
+    }
+
+    // Function to display the state of all processes in the system
+    void displayState() {
+        if (count == 0) {
+            cout << "No processes in the system." << endl;
+            return;
+        }
+        for (size_t i = 0; i < count; i++) {
+            size_t slot = (start + i) & (ids.size() - 1);
+            cout << "P" << ids[slot] << " (Remaining: " << remaining[slot] << ") ";
+        }
+        cout << endl;
+    }
+
+    // Function to simulate the entire scheduling process, running cycles until all processes are completed
+    void simulate() {
+        int cycleCount = 1;
+        while (count > 0) {
+            runCycle(cycleCount);
+        }
+    }
+};
+
+// Lock-free work-stealing deque of processes (Chase-Lev). The owning core pushes at the
+// bottom; any core, the owner included, takes from the top with a CAS. The owner taking
+// from the top keeps its own run queue in round-robin order while thieves compete for
+// the same end. The buffer doubles when full; old buffers are kept until destruction
+// because a concurrent thief may still be reading them.
+class WorkStealingDeque {
+private:
+    struct Buffer {
+        size_t capacity;               // Power of two
+        atomic<Process*>* slots;       // Ring of process pointers
+
+        Buffer(size_t capacity) : capacity(capacity), slots(new atomic<Process*>[capacity]) {}
+        ~Buffer() { delete[] slots; }
+        Process* get(long long index) { return slots[index & (capacity - 1)].load(memory_order_relaxed); }
+        void put(long long index, Process* process) { slots[index & (capacity - 1)].store(process, memory_order_relaxed); }
+    };
+
+    atomic<long long> top;             // Next index to take, advanced by CAS
+    atomic<long long> bottom;          // Next index to push, written only by the owner
+    atomic<Buffer*> buffer;            // Current ring
+    vector<Buffer*> retired;           // Every ring ever used, freed by the destructor
+
+public:
+    // Constructor with an initial capacity (rounded up to a power of two)
+    WorkStealingDeque(size_t capacity = 1024) : top(0), bottom(0) {
+        size_t size = 1;
+        while (size < capacity) size *= 2;
+        Buffer* initial = new Buffer(size);
+        retired.push_back(initial);
+        buffer.store(initial, memory_order_relaxed);
+    }
+
+    // Function for the owner to add a process at the bottom
+    void push(Process* process) {
+        long long b = bottom.load(memory_order_relaxed);
+        long long t = top.load(memory_order_acquire);
+        Buffer* current = buffer.load(memory_order_relaxed);
+        if (b - t > (long long)current->capacity - 1) {  // Full: copy into a ring twice the size
+            Buffer* bigger = new Buffer(current->capacity * 2);
+            for (long long i = t; i < b; i++) {
+                bigger->put(i, current->get(i));
+            }
+            retired.push_back(bigger);
+            buffer.store(bigger, memory_order_release);
+            current = bigger;
+        }
+        current->put(b, process);
+        bottom.store(b + 1, memory_order_release);  // Publishes the slot to thieves
+    }
+
+    // Function for any core to take the process at the top; nullptr if empty or lost a race
+    Process* steal() {
+        long long t = top.load(memory_order_seq_cst);  // Top must be read before bottom
+        long long b = bottom.load(memory_order_seq_cst);
+        if (t >= b) return nullptr;
+        Process* process = buffer.load(memory_order_acquire)->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            return nullptr;  // Another core took it first
+        }
+        return process;
+    }
+
+    // Approximate number of processes in the deque
+    long long size() const {
+        long long b = bottom.load(memory_order_relaxed);
+        long long t = top.load(memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+    // Destructor
+    ~WorkStealingDeque() {
+        for (Buffer* old : retired) delete old;
+    }
+};
+
+// Result of one process run by the multi-core scheduler
+struct CompletedProcess {
+    int process_id;
+    int execution_time;     // CPU time the process asked for
+    long long cpu_time;     // CPU time it received, summed over its slices
+    int dispatches;         // Number of quanta it was given, counted on every dispatch
+    int core;               // Core that finished it
+    long long finish_time;  // Simulated time on that core when it finished
+};
+
+// Multi-core round-robin simulation. Every core runs the runCycle logic of
+// ProcessScheduler on its own WorkStealingDeque: each cycle visits the processes
+// queued at its start, giving each one quantum and re-queuing it if unfinished. A core
+// with nothing to run steals from a random other core. addProcess may be called from
+// any number of producer threads while the cores are running; new processes go to a
+// per-core lock-free inbox that the core drains at the start of each cycle.
+class MultiCoreScheduler {
+private:
+    struct Core {
+        WorkStealingDeque runQueue;          // This core's round-robin queue
+        atomic<Process*> inbox;              // Lock-free stack of newly added processes
+        vector<CompletedProcess> completed;  // Written only by this core's thread
+        long long dispatches = 0;            // Quanta run on this core
+        long long steals = 0;                // Processes taken from other cores
+        long long failedSteals = 0;          // Steal attempts that found nothing
+        long long busyTime = 0;              // Simulated CPU time spent running processes
+        long long cycles = 0;                // Round-robin cycles run
+        long long queueLengthSum = 0;        // Sum over cycles of the queue length at cycle start
+        Core() : inbox(nullptr) {}
+    };
+
+    vector<Core*> cores;
+    vector<thread> threads;
+    const int cpu_time_per_cycle;          // CPU time assigned to each process per dispatch
+    atomic<long long> outstanding;         // Processes added but not yet completed
+    atomic<unsigned> nextCore;             // Round-robin placement of new processes
+    atomic<bool> admissionClosed;          // Set once no more processes will be added
+
+    // Function to move everything in a core's inbox onto its run queue, oldest first
+    void drainInbox(Core& core) {
+        Process* list = core.inbox.exchange(nullptr, memory_order_acquire);
+        Process* reversed = nullptr;  // The inbox is a stack, reverse it to keep arrival order
+        while (list) {
+            Process* following = list->next;
+            list->next = reversed;
+            reversed = list;
+            list = following;
+        }
+        while (reversed) {
+            Process* following = reversed->next;
+            core.runQueue.push(reversed);
+            reversed = following;
+        }
+    }
+
+    // Function that runs one quantum of a process on a core; returns true when it finished
+    bool dispatch(Core& core, Process* process, int coreIndex) {
+        int slice = min(cpu_time_per_cycle, process->remaining_time);
+        process->remaining_time -= cpu_time_per_cycle;
+        process->next = nullptr;
+        process->dispatches++;  // Counted wherever the process runs, stolen or not
+        process->cpu_time += slice;
+        core.busyTime += slice;
+        core.dispatches++;
+        if (process->remaining_time <= 0) {
+            core.completed.push_back({process->process_id, process->execution_time, process->cpu_time,
+                                      process->dispatches, coreIndex, core.busyTime});
+            delete process;
+            outstanding.fetch_sub(1, memory_order_acq_rel);
+            return true;
+        }
+        return false;
+    }
+
+    // Body of each core thread
+    void coreLoop(int coreIndex, unsigned seed) {
+        Core& core = *cores[coreIndex];
+        minstd_rand random(seed);  // Victim selection
+        while (true) {
+            drainInbox(core);
+            long long visits = core.runQueue.size();  // Processes queued at the start of this cycle
+            if (visits > 0) {
+                core.cycles++;
+                core.queueLengthSum += visits;
+                while (visits-- > 0) {
+                    Process* process = core.runQueue.steal();  // Own top, in round-robin order
+                    if (!process) break;  // A thief emptied the queue
+                    if (!dispatch(core, process, coreIndex)) {
+                        core.runQueue.push(process);  // Unfinished, back of the queue
+                    }
+                }
+                continue;
+            }
+            if (admissionClosed.load(memory_order_acquire) && outstanding.load(memory_order_acquire) == 0) {
+                return;  // Everything added has completed
+            }
+            // Idle: steal one process from a random other core and run it here
+            Process* stolen = nullptr;
+            if (cores.size() > 1) {
+                int victim = (int)(random() % (cores.size() - 1));
+                if (victim >= coreIndex) victim++;
+                stolen = cores[victim]->runQueue.steal();
+            }
+            if (stolen) {
+                core.steals++;
+                if (!dispatch(core, stolen, coreIndex)) {
+                    core.runQueue.push(stolen);
+                }
+            } else {
+                core.failedSteals++;
+                this_thread::yield();
+            }
+        }
+    }
+
+public:
+    // Constructor
+    MultiCoreScheduler(int coreCount, int quantum = 3)
+        : cpu_time_per_cycle(quantum), outstanding(0), nextCore(0), admissionClosed(false) {
+        for (int i = 0; i < coreCount; i++) {
+            cores.push_back(new Core());
+        }
+    }
+
+    // Function to add a process; safe to call from any thread, before or after start()
+    void addProcess(int process_id, int execution_time) {
+        Process* process = new Process(process_id, execution_time);
+        outstanding.fetch_add(1, memory_order_acq_rel);
+        Core& core = *cores[nextCore.fetch_add(1, memory_order_relaxed) % cores.size()];
+        Process* first = core.inbox.load(memory_order_relaxed);
+        do {
+            process->next = first;
+        } while (!core.inbox.compare_exchange_weak(first, process, memory_order_release, memory_order_relaxed));
+    }
+
+    // Function to start one thread per core
+    void start() {
+        for (size_t i = 0; i < cores.size(); i++) {
+            threads.emplace_back(&MultiCoreScheduler::coreLoop, this, (int)i, (unsigned)(i * 7919 + 1));
+        }
+    }
+
+    // Function to declare that no more processes will be added and wait for every core to finish
+    void finish() {
+        admissionClosed.store(true, memory_order_release);
+        for (thread& worker : threads) {
+            worker.join();
+        }
+        threads.clear();
+    }
+
+    // Completed processes from every core, sorted by process ID
+    vector<CompletedProcess> results() const {
+        vector<CompletedProcess> all;
+        for (Core* core : cores) {
+            all.insert(all.end(), core->completed.begin(), core->completed.end());
+        }
+        sort(all.begin(), all.end(), [](const CompletedProcess& a, const CompletedProcess& b) {
+            return a.process_id < b.process_id;
+        });
+        return all;
+    }
+
+    // Function to print per-core dispatches, steals, average queue length and the load imbalance
+    void displayStats() const {
+        long long maxBusy = 0, totalBusy = 0, totalSteals = 0;
+        for (size_t i = 0; i < cores.size(); i++) {
+            const Core& core = *cores[i];
+            cout << "  core " << i << ": " << core.dispatches << " dispatches, " << core.steals << " steals, "
+                 << core.failedSteals << " failed steals, avg queue "
+                 << (core.cycles ? (double)core.queueLengthSum / core.cycles : 0.0) << endl;
+            maxBusy = max(maxBusy, core.busyTime);
+            totalBusy += core.busyTime;
+            totalSteals += core.steals;
+        }
+        double averageBusy = (double)totalBusy / cores.size();
+        cout << "  steals: " << totalSteals << ", imbalance (max/avg busy time): "
+             << (averageBusy > 0 ? maxBusy / averageBusy : 0.0) << endl;
+    }
+
+    // Destructor
+    ~MultiCoreScheduler() {
+        if (!threads.empty()) finish();
+        for (Core* core : cores) {
+            drainInbox(*core);
+            while (Process* process = core->runQueue.steal()) delete process;
+            delete core;
+        }
+    }
+};
+
+// Interface for a scheduling policy run by PolicyScheduler. The policy owns the ready
+// queue: the scheduler hands it every process that becomes ready and asks it which
+// process to run next and for how long.
+class SchedulingPolicy {
+public:
+    virtual ~SchedulingPolicy() {}
+
+    // Name used in reports
+    virtual string name() const = 0;
+
+    // Function to add a process that has arrived or been preempted to the ready queue
+    virtual void enqueue(Process* process, long long now) = 0;
+
+    // Function to take the next process to run off the ready queue; nullptr if it is empty
+    virtual Process* pickNext(long long now) = 0;
+
+    // Function returning the longest time the process may run before it is preempted
+    virtual int timeSlice(const Process* process) const = 0;
+
+    // Whether a newly arrived process may preempt the running one
+    virtual bool preemptsOnArrival() const {
+        return false;
+    }
+
+    // Called after each slice with the time the process used, before it is re-queued
+    virtual void sliceFinished(Process* process, int used) {
+        (void)process;
+        (void)used;
+    }
+};
+
+// Round robin: a FIFO ready queue with a configurable quantum; a process's own
+// quantum field overrides the default
+class RoundRobinPolicy : public SchedulingPolicy {
+private:
+    deque<Process*> ready;
+    const int cpu_time_per_cycle;
+
+public:
+    // Constructor
+    RoundRobinPolicy(int quantum = 3) : cpu_time_per_cycle(quantum) {}
+
+    string name() const override {
+        return "RR (quantum " + to_string(cpu_time_per_cycle) + ")";
+    }
+
+    void enqueue(Process* process, long long) override {
+        ready.push_back(process);
+    }
+
+    Process* pickNext(long long) override {
+        if (ready.empty()) return nullptr;
+        Process* process = ready.front();
+        ready.pop_front();
+        return process;
+    }
+
+    int timeSlice(const Process* process) const override {
+        return process->quantum > 0 ? process->quantum : cpu_time_per_cycle;
+    }
+};
+
+// Shortest remaining time first: a min-heap on remaining_time (ties go to the earlier
+// arrival), preempting the running process whenever a new one arrives
+class ShortestRemainingTimePolicy : public SchedulingPolicy {
+private:
+    struct LongerRemaining {
+        bool operator()(const Process* a, const Process* b) const {
+            if (a->remaining_time != b->remaining_time) return a->remaining_time > b->remaining_time;
+            if (a->arrival_time != b->arrival_time) return a->arrival_time > b->arrival_time;
+            return a->process_id > b->process_id;
+        }
+    };
+    priority_queue<Process*, vector<Process*>, LongerRemaining> ready;
+
+public:
+    string name() const override {
+        return "SRTF";
+    }
+
+    void enqueue(Process* process, long long) override {
+        ready.push(process);
+    }
+
+    Process* pickNext(long long) override {
+        if (ready.empty()) return nullptr;
+        Process* process = ready.top();
+        ready.pop();
+        return process;
+    }
+
+    int timeSlice(const Process* process) const override {
+        return process->remaining_time;  // Runs to completion unless an arrival preempts it
+    }
+
+    bool preemptsOnArrival() const override {
+        return true;
+    }
+};
+
+// Multilevel feedback queue. A process starts at the level given by its priority; level k
+// has a quantum of base << k. A process that uses its whole quantum drops one level, and a
+// process that has waited aging_time in a lower level is promoted one level, so batch jobs
+// cannot starve.
+class MultilevelFeedbackPolicy : public SchedulingPolicy {
+private:
+    vector<deque<Process*>> levels;  // Ready queue per level, level 0 runs first
+    const int base_quantum;
+    const long long aging_time;
+
+    // Function to promote every process that has waited too long in its level
+    void age(long long now) {
+        for (int level = 1; level < (int)levels.size(); level++) {
+            deque<Process*>& queue = levels[level];
+            while (!queue.empty() && now - queue.front()->ready_time >= aging_time) {  // Oldest first
+                Process* process = queue.front();
+                queue.pop_front();
+                process->priority = level - 1;
+                process->ready_time = now;
+                levels[level - 1].push_back(process);
+            }
+        }
+    }
+
+public:
+    // Constructor
+    MultilevelFeedbackPolicy(int levelCount = 3, int baseQuantum = 2, long long agingTime = 200)
+        : levels(levelCount), base_quantum(baseQuantum), aging_time(agingTime) {}
+
+    string name() const override {
+        return "MLFQ (" + to_string(levels.size()) + " levels)";
+    }
+
+    void enqueue(Process* process, long long now) override {
+        process->priority = min(max(process->priority, 0), (int)levels.size() - 1);
+        process->ready_time = now;
+        levels[process->priority].push_back(process);
+    }
+
+    Process* pickNext(long long now) override {
+        age(now);
+        for (deque<Process*>& queue : levels) {
+            if (!queue.empty()) {
+                Process* process = queue.front();
+                queue.pop_front();
+                return process;
+            }
+        }
+        return nullptr;
+    }
+
+    int timeSlice(const Process* process) const override {
+        return base_quantum << process->priority;
+    }
+
+    void sliceFinished(Process* process, int used) override {
+        if (used >= timeSlice(process) && process->priority + 1 < (int)levels.size()) {
+            process->priority++;  // Used its whole quantum: treat it as a batch job
+        }
+    }
+};
+
+// Turnaround and waiting time statistics of one policy on one workload
+struct PolicyReport {
+    string policy;
+    double averageTurnaround;
+    long long p99Turnaround;
+    double averageWaiting;
+    long long p99Waiting;
+    long long contextSwitches;  // Slices run
+};
+
+// Workload traces. A trace is a sequence of (arrival_time, process_id, execution_time,
+// priority) records in arrival order, stored either as CSV text, one record per line
+// (priority optional, a header line allowed), or in the compact binary format: the
+// 8-byte magic "RRTRACE1" followed by four little-endian 32-bit integers per record.
+// Readers stream the file through one fixed-size buffer, so memory use does not grow
+// with the trace.
+const char trace_magic[8] = {'R', 'R', 'T', 'R', 'A', 'C', 'E', '1'};
+const size_t trace_record_size = 4 * sizeof(int32_t); // Bytes per binary record
+const size_t trace_chunk_size = 1 << 20;              // Bytes read from the file at a time
+
+// Base class of the trace readers: owns the file and the chunk buffer
+class TraceReader {
+protected:
+    FILE* file;
+    vector<char> buffer;
+    size_t position;  // Next unread byte in the buffer
+    size_t filled;    // Bytes of the buffer holding file data
+    long long records;
+
+    // Function to keep the unread bytes and read the next chunk after them; false at end of file
+    bool refill() {
+        size_t left = filled - position;
+        memmove(buffer.data(), buffer.data() + position, left);
+        position = 0;
+        filled = left;
+        size_t got = fread(buffer.data() + filled, 1, buffer.size() - filled, file);
+        filled += got;
+        return got > 0;
+    }
+
+public:
+    // Constructor; check isOpen() before reading
+    TraceReader(const string& path)
+        : file(fopen(path.c_str(), "rb")), buffer(trace_chunk_size), position(0), filled(0), records(0) {}
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    // Whether the file could be opened and has the expected format
+    bool isOpen() const {
+        return file != nullptr;
+    }
+
+    // Number of records returned so far
+    long long recordCount() const {
+        return records;
+    }
+
+    // Function to read the next record; false at the end of the trace
+    virtual bool next(ProcessSpec& record) = 0;
+
+    // Destructor
+    virtual ~TraceReader() {
+        if (file) fclose(file);
+    }
+};
+
+// Reader for CSV traces: arrival_time,process_id,execution_time[,priority]
+class CsvTraceReader : public TraceReader {
+private:
+    long long skipped;  // Header, blank and malformed lines
+    bool discarding;    // Inside a line too long for the buffer, skipping to its end
+
+    // Function to parse one line into a record; false if it is not a record
+    bool parse(const char* first, const char* last, ProcessSpec& record) {
+        int fields[4] = {0, 0, 0, 0};
+        int count = 0;
+        while (count < 4) {
+            while (first < last && (*first == ' ' || *first == '\t')) first++;
+            auto [end, error] = from_chars(first, last, fields[count]);
+            if (error != errc()) break;
+            count++;
+            first = end;
+            while (first < last && (*first == ' ' || *first == '\t' || *first == '\r')) first++;
+            if (first == last || *first != ',') break;
+            first++;
+        }
+        if (count < 3) return false;
+        record = {fields[1], fields[2], fields[3], fields[0]};
+        return true;
+    }
+
+public:
+    // Constructor
+    CsvTraceReader(const string& path) : TraceReader(path), skipped(0), discarding(false) {}
+
+    // Number of lines that were not records
+    long long skippedLines() const {
+        return skipped;
+    }
+
+    bool next(ProcessSpec& record) override {
+        if (!file) return false;
+        while (true) {
+            char* first = buffer.data() + position;
+            char* last = buffer.data() + filled;
+            char* newline = static_cast<char*>(memchr(first, '\n', last - first));
+            if (!newline) {
+                if (position == 0 && filled == buffer.size()) {  // A line longer than the buffer
+                    skipped += !discarding;
+                    discarding = true;
+                    position = filled;
+                }
+                if (refill()) continue;
+                if (position == filled) return false;  // End of file
+                newline = buffer.data() + filled;      // Last line without a newline
+                first = buffer.data() + position;
+            }
+            position = min(filled, (size_t)(newline - buffer.data()) + 1);
+            if (discarding) {  // The end of an overlong line
+                discarding = false;
+                continue;
+            }
+            if (parse(first, newline, record)) {
+                records++;
+                return true;
+            }
+            skipped++;
+        }
+    }
+};
+
+// Reader for binary traces
+class BinaryTraceReader : public TraceReader {
+public:
+    // Constructor; the file is closed again if it does not start with the trace magic
+    BinaryTraceReader(const string& path) : TraceReader(path) {
+        if (file && (!refillAtLeast(sizeof(trace_magic)) || memcmp(buffer.data(), trace_magic, sizeof(trace_magic)) != 0)) {
+            fclose(file);
+            file = nullptr;
+        }
+        position = sizeof(trace_magic);
+    }
+
+    // Function to make sure the buffer holds at least bytes unread bytes; false if the file is too short
+    bool refillAtLeast(size_t bytes) {
+        while (filled - position < bytes) {
+            if (!refill()) return false;
+        }
+        return true;
+    }
+
+    bool next(ProcessSpec& record) override {
+        if (!file || !refillAtLeast(trace_record_size)) return false;
+        int32_t fields[4];
+        memcpy(fields, buffer.data() + position, trace_record_size);  // The format is little-endian, like the host
+        position += trace_record_size;
+        record = {fields[1], fields[2], fields[3], fields[0]};
+        records++;
+        return true;
+    }
+};
+
+// Function to open a trace of either format, choosing the binary reader when the file
+// starts with the trace magic
+unique_ptr<TraceReader> openTrace(const string& path);
+
+// Buffered writer for binary traces
+class BinaryTraceWriter {
+private:
+    FILE* file;
+    vector<char> buffer;
+    size_t filled;
+
+    // Function to write out the buffered records
+    void flush() {
+        if (file && filled > 0) fwrite(buffer.data(), 1, filled, file);
+        filled = 0;
+    }
+
+public:
+    // Constructor; writes the magic. Check isOpen() before writing
+    BinaryTraceWriter(const string& path) : file(fopen(path.c_str(), "wb")), buffer(trace_chunk_size), filled(0) {
+        if (file) fwrite(trace_magic, 1, sizeof(trace_magic), file);
+    }
+
+    BinaryTraceWriter(const BinaryTraceWriter&) = delete;
+    BinaryTraceWriter& operator=(const BinaryTraceWriter&) = delete;
+
+    // Whether the file could be created
+    bool isOpen() const {
+        return file != nullptr;
+    }
+
+    // Function to append one record
+    void write(const ProcessSpec& record) {
+        if (filled + trace_record_size > buffer.size()) flush();
+        int32_t fields[4] = {record.arrival_time, record.process_id, record.execution_time, record.priority};
+        memcpy(buffer.data() + filled, fields, trace_record_size);
+        filled += trace_record_size;
+    }
+
+    // Destructor; flushes and closes the file
+    ~BinaryTraceWriter() {
+        flush();
+        if (file) fclose(file);
+    }
+};
+
+// Function to convert a CSV trace into a binary one; returns the number of records, or -1
+// if either file could not be opened
+long long convertCsvTrace(const string& csvPath, const string& binaryPath);
+
+// Function to get the peak resident set size of this process, in kilobytes
+long peakResidentKilobytes();
+
+// Discrete-event simulation of a single CPU under a SchedulingPolicy. Processes arrive at
+// their arrival_time; the CPU runs the policy's choice for its time slice, cut short by the
+// next arrival if the policy preempts on arrival, and jumps ahead when nothing is ready.
+// Each slice is reported to the event sink as a cycle of its own, numbered from 1: a run
+// event, then a preempt or complete event. The policy owns the ready queue, so no
+// snapshots are sent.
+class PolicyScheduler {
+private:
+    SchedulingPolicy& policy;
+    ProcessPool pool;  // Owns the memory of every process node
+    EventSink* sink;   // Receives the events of every slice
+
+public:
+    // Constructor
+    PolicyScheduler(SchedulingPolicy& policy) : policy(policy), sink(&nullEventSink()) {}
+
+    // Function to send the scheduler's events to a sink. By default they are discarded,
+    // since replaying a trace would otherwise print every slice.
+    void setEventSink(EventSink& eventSink) {
+        sink = &eventSink;
+    }
+
+    // Function to run the simulation, pulling records in arrival order from nextRecord(ProcessSpec&)
+    // only when simulated time reaches them. A record that arrives out of order is admitted
+    // as soon as it is read.
+    template <typename NextRecord>
+    PolicyReport simulate(NextRecord nextRecord) {
+        Histogram turnaround, waiting;
+        long long now = 0;
+        long long slices = 0;
+        long long live = 0;  // Processes admitted but not finished
+        ProcessSpec upcoming{0, 0};
+        bool more = nextRecord(upcoming);
+
+        // Function to hand every process that has arrived by now to the policy
+        auto admitArrivals = [&]() {
+            while (more && upcoming.arrival_time <= now) {
+                policy.enqueue(pool.acquire(upcoming.process_id, upcoming.execution_time, upcoming.priority,
+                                            upcoming.arrival_time, upcoming.quantum), now);
+                live++;
+                more = nextRecord(upcoming);
+            }
+        };
+
+        while (more || live > 0) {
+            admitArrivals();
+            Process* process = policy.pickNext(now);
+            if (!process) {  // Idle until the next arrival
+                now = upcoming.arrival_time;
+                continue;
+            }
+            long long slice = min(policy.timeSlice(process), process->remaining_time);
+            if (policy.preemptsOnArrival() && more) {
+                slice = min(slice, max(1LL, upcoming.arrival_time - now));
+            }
+            slice = max(slice, 0LL);  // A zero-length process completes on its first dispatch
+            slices++;
+            sink->cycleStarted((int)slices);
+            sink->record({EventType::Run, (int)slices, now, process->process_id, (int)slice});
+            now += slice;
+            process->remaining_time -= (int)slice;
+            policy.sliceFinished(process, (int)slice);
+            admitArrivals();  // Arrivals during the slice queue ahead of the preempted process
+            if (process->remaining_time > 0) {
+                sink->record({EventType::Preempt, (int)slices, now, process->process_id, process->remaining_time});
+                sink->cycleFinished((int)slices);
+                policy.enqueue(process, now);
+            } else {
+                sink->record({EventType::Complete, (int)slices, now, process->process_id, 0});
+                sink->cycleFinished((int)slices);
+                turnaround.add(now - process->arrival_time);
+                waiting.add(now - process->arrival_time - process->execution_time);
+                pool.release(process);
+                live--;
+            }
+        }
+
+        return {policy.name(), turnaround.mean(), turnaround.percentile(99),
+                waiting.mean(), waiting.percentile(99), slices};
+    }
+
+    // Function to run a workload to completion and report its turnaround and waiting times
+    PolicyReport run(span<const ProcessSpec> workload) {
+        vector<const ProcessSpec*> arrivals;  // Workload in arrival order
+        for (const ProcessSpec& spec : workload) arrivals.push_back(&spec);
+        stable_sort(arrivals.begin(), arrivals.end(), [](const ProcessSpec* a, const ProcessSpec* b) {
+            return a->arrival_time < b->arrival_time;
+        });
+        size_t arrived = 0;
+        return simulate([&](ProcessSpec& record) {
+            if (arrived == arrivals.size()) return false;
+            record = *arrivals[arrived++];
+            return true;
+        });
+    }
+
+    // Function to replay a trace, reading records only as simulated time reaches them
+    PolicyReport replay(TraceReader& trace) {
+        return simulate([&](ProcessSpec& record) { return trace.next(record); });
+    }
+};
@@ -0,0 +1,38 @@
+// Reference implementations shared by Tests.cpp and Benchmarks.cpp: plain limb loops
+// that the optimized kernels in LargeNumber.h are checked and timed against
+#pragma once
+#include <cstdint>
+
+// Reference a + b over length limbs with carries found by comparison; sum may be a
+inline uint64_t referenceAdd(const uint64_t* a, const uint64_t* b, int length, uint64_t* sum) {
+    uint64_t carry = 0;
+    for (int i = 0; i < length; ++i) {
+        uint64_t partial = a[i] + carry;
+        uint64_t nextCarry = (partial < carry);
+        partial += b[i];
+        nextCarry += (partial < b[i]);
+        sum[i] = partial;
+        carry = nextCarry;
+    }
+    return carry;
+}
+
+// Reference a - b over length limbs with borrows found by comparison
+inline uint64_t referenceSubtract(const uint64_t* a, const uint64_t* b, int length, uint64_t* difference) {
+    uint64_t borrow = 0;
+    for (int i = 0; i < length; ++i) {
+        uint64_t partial = a[i] - b[i];
+        uint64_t nextBorrow = (a[i] < b[i]) | (partial < borrow);
+        difference[i] = partial - borrow;
+        borrow = nextBorrow;
+    }
+    return borrow;
+}
+
+// Reference a >= b, comparing from the most significant limb
+inline bool referenceAtLeast(const uint64_t* a, const uint64_t* b, int length) {
+    for (int i = length - 1; i >= 0; --i) {
+        if (a[i] != b[i]) return a[i] > b[i];
+    }
+    return true;
+}
@@ -0,0 +1,828 @@
+// Correctness tests for both assignments, registered with ctest. Every check prints a
+// pass or FAIL line, and the program exits with status 1 if any check failed.
+//
+// Usage: assignment_tests [--list] [<test name>...]   (no names runs every test)
+#include "LargeNumber.h"
+#include "ProcessScheduler.h"
+#include "TestSupport.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <cmath>
+using namespace std;
+
+// Heap allocations made through the global operator new, read by the allocation check
+atomic<long long> heap_allocations(0);
+
+void* operator new(size_t size) {
+    heap_allocations.fetch_add(1, memory_order_relaxed);
+    void* memory = malloc(size ? size : 1);
+    if (!memory) throw bad_alloc();
+    return memory;
+}
+
+// GCC flags free() here as mismatched with new, but this pair replaces the global operators
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+#pragma GCC diagnostic pop
+
+// Limb for the carry kernel fuzz check, biased towards 0 and all ones so that long carry
+// and borrow chains come up often
+uint64_t fuzzLimb(Xoshiro256StarStar& random) {
+    switch (random.next() % 4) {
+        case 0: return 0;
+        case 1: return ~0ULL;
+        case 2: return ~0ULL - random.next() % 4;
+        default: return random.next();
+    }
+}
+
+// Check the carry kernels against the reference loops on fuzzed inputs: add, subtract and
+// compare at random lengths, the batched add at every instruction set this CPU supports,
+// and list LargeNumber addition carrying out of a limb
+bool checkCarryKernels() {
+    Xoshiro256StarStar random(19);
+    const int trials = 20000;
+    long long mismatches = 0;
+    for (int trial = 0; trial < trials; ++trial) {
+        int length = 1 + random.next() % 40;
+        int shorter = 1 + random.next() % length; // Addend length for the uneven kernels
+        vector<uint64_t> a(length), b(length, 0), expected(length), actual(length);
+        for (uint64_t& limb : a) limb = fuzzLimb(random);
+        if (trial % 2) { // Equal or nearly equal operands exercise the compare
+            b = a;
+            if (trial % 4 == 1) b[random.next() % length] = fuzzLimb(random);
+        } else {
+            for (int i = 0; i < shorter; ++i) b[i] = fuzzLimb(random);
+        }
+        if (trial % 2) shorter = length;
+
+        uint64_t expectedCarry = referenceAdd(a.data(), b.data(), length, expected.data());
+        actual = a;
+        mismatches += (addLimbsInPlace(actual.data(), length, b.data(), shorter) != expectedCarry) || actual != expected;
+        mismatches += (addLimbs(a.data(), length, b.data(), shorter, actual.data()) != expectedCarry) || actual != expected;
+
+        uint64_t expectedBorrow = referenceSubtract(a.data(), b.data(), length, expected.data());
+        actual = a;
+        mismatches += (subtractLimbsInPlace(actual.data(), length, b.data(), shorter) != expectedBorrow) || actual != expected;
+
+        mismatches += limbsAtLeast(a.data(), b.data(), length) != referenceAtLeast(a.data(), b.data(), length);
+        mismatches += limbsAtLeast(b.data(), a.data(), length) != referenceAtLeast(b.data(), a.data(), length);
+    }
+    cout << "carry kernels: " << trials << " fuzzed add/subtract/compare cases, " << mismatches << " mismatches"
+         << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    bool passed = mismatches == 0;
+
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+        if (level > detectSimdLevel()) break;
+        const int batches = 500;
+        mismatches = 0;
+        for (int batch = 0; batch < batches; ++batch) {
+            int length = 1 + random.next() % 24;
+            int count = 1 + random.next() % 37; // Includes counts that leave a scalar tail
+            vector<uint64_t> a((size_t)length * count), b(a.size()), carries(count);
+            for (uint64_t& limb : a) limb = fuzzLimb(random);
+            for (uint64_t& limb : b) limb = fuzzLimb(random);
+            vector<uint64_t> sum = a;
+            addLimbsBatch(sum.data(), b.data(), length, count, carries.data(), level);
+            vector<uint64_t> x(length), y(length), expected(length);
+            for (int k = 0; k < count; ++k) { // Each number against the reference on its own
+                for (int i = 0; i < length; ++i) {
+                    x[i] = a[(size_t)i * count + k];
+                    y[i] = b[(size_t)i * count + k];
+                }
+                uint64_t carry = referenceAdd(x.data(), y.data(), length, expected.data());
+                bool same = carries[k] == carry;
+                for (int i = 0; i < length; ++i) same = same && sum[(size_t)i * count + k] == expected[i];
+                mismatches += !same;
+            }
+        }
+        cout << "carry kernels: " << batches << " fuzzed batched adds (" << simdLevelName(level) << "), "
+             << mismatches << " mismatches" << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+        passed = passed && mismatches == 0;
+    }
+
+    // The list backend: a carry out of a node must reach the next one, and (a + b) - b == a
+    mismatches = 0;
+    LargeNumber allOnes(~0ULL);
+    LargeNumber carried = allOnes + LargeNumber(1);
+    mismatches += carried.isZero() || !(carried >= allOnes) || allOnes >= carried;
+    mismatches += !(carried - LargeNumber(1) == allOnes);
+    for (int trial = 0; trial < 200; ++trial) {
+        LargeNumber a, b;
+        a.generateRandom();
+        b.generateRandom();
+        LargeNumber sum = a + b;
+        mismatches += !(sum - b == a) || !(sum >= a) || a >= sum;
+    }
+    cout << "carry kernels: list LargeNumber add/subtract/compare, " << mismatches << " mismatches"
+         << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return passed && mismatches == 0;
+}
+
+// Check isPrimeBatch at one width at every instruction set this CPU supports: against
+// isPrime in a loop on consecutive odd numbers, and against the known answer for primes,
+// products of two primes, small primes and small Carmichael numbers
+template <int Bits>
+bool checkPrimalityBatchAt(int consecutive, int primes) {
+    typedef FixedLargeNumber<Bits> Number;
+    vector<Number> candidates;
+    vector<int> known; // 1 for a known prime, 0 for a known composite, -1 when only isPrime decides
+    Number candidate;
+    candidate.generateRandom();
+    candidate.setLimb(0, candidate.limb(0) | 1);
+    for (int i = 0; i < consecutive; ++i) {
+        candidates.push_back(candidate);
+        known.push_back(-1);
+        candidate += Number(2); // Next odd candidate
+    }
+    for (const Number& prime : PrimeSearch<Bits>(1).findPrimes(primes)) {
+        candidates.push_back(prime);
+        known.push_back(1);
+    }
+    vector<FixedLargeNumber<Bits / 2>> factors = PrimeSearch<Bits / 2>(1).findPrimes(2);
+    candidates.push_back(factors[0] * factors[1]); // Full-width semiprime with no small factor
+    known.push_back(0);
+    Number mersenne61((1ULL << 61) - 1);
+    Number fermat64; // 2^64 + 1 = 274177 * 67280421310721
+    fermat64.setLimb(0, 1);
+    fermat64.setLimb(1, 1);
+    for (auto [value, prime] : vector<pair<Number, int>>{{Number(1), 0}, {Number(3), 1}, {Number(5), 1}, {Number(7), 1},
+                                                         {Number(561), 0}, {Number(1105), 0}, {mersenne61, 1}, {fermat64, 0}}) {
+        candidates.push_back(value);
+        known.push_back(prime);
+    }
+
+    vector<bool> expected(candidates.size());
+    long long mismatches = 0;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        expected[i] = candidates[i].isPrime();
+        mismatches += known[i] >= 0 && expected[i] != (known[i] == 1);
+    }
+    cout << "primality batch " << Bits << " isPrime: " << candidates.size() << " candidates, " << mismatches
+         << " wrong" << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    bool passed = mismatches == 0;
+
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+        if (level > detectSimdLevel()) break;
+        vector<bool> verdicts = MillerRabinBatch<Bits>(5, level).test(candidates);
+        mismatches = 0;
+        for (size_t i = 0; i < candidates.size(); ++i) mismatches += verdicts[i] != expected[i];
+        cout << "primality batch " << Bits << " isPrimeBatch (" << simdLevelName(level) << "): " << candidates.size()
+             << " candidates, " << mismatches << " differ from isPrime" << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+        passed = passed && mismatches == 0;
+    }
+    return passed;
+}
+
+// Function to build the list number prime * (1 + 2^(64 * shift)) for a shift of at least
+// the prime's width: composite, but its low limbs hold the prime, so testing a truncated
+// copy would call it prime. A shift of 0 gives the prime itself.
+template <int Bits>
+LargeNumber primeRepeatedAbove(const FixedLargeNumber<Bits>& prime, int shift) {
+    vector<uint64_t> limbs(shift + Bits / 64, 0);
+    for (int i = 0; i < Bits / 64; ++i) {
+        limbs[i] = prime.limb(i);
+        limbs[shift + i] = prime.limb(i);
+    }
+    LargeNumber number;
+    number.assignLimbs(limbs.data(), (int)limbs.size());
+    return number;
+}
+
+// Check isPrimeBatch against isPrime at 1024, 2048 and 4096 bits, and the list overload,
+// with candidates wider than 1024 bits whose low 1024 or 2048 bits are prime
+bool checkPrimalityBatch() {
+    bool passed = checkPrimalityBatchAt<1024>(64, 4);
+    passed = checkPrimalityBatchAt<2048>(32, 2) && passed;
+    passed = checkPrimalityBatchAt<4096>(8, 1) && passed;
+
+    vector<LargeNumber> numbers(16);
+    vector<int> known(numbers.size(), -1); // As in checkPrimalityBatchAt
+    for (LargeNumber& number : numbers) number.generateRandom();
+    LargeNumber1024 prime1024 = PrimeSearch<1024>(1).findPrimes(1)[0];
+    LargeNumber2048 prime2048 = PrimeSearch<2048>(1).findPrimes(1)[0];
+    for (auto [number, prime] : vector<pair<LargeNumber, int>>{{primeRepeatedAbove(prime1024, 0), 1},
+                                                               {primeRepeatedAbove(prime1024, 16), 0},
+                                                               {primeRepeatedAbove(prime2048, 0), 1},
+                                                               {primeRepeatedAbove(prime2048, 32), 0},
+                                                               {primeRepeatedAbove(prime1024, 64), 0}}) {
+        numbers.push_back(number);
+        known.push_back(prime);
+    }
+    vector<bool> verdicts = isPrimeBatch(numbers);
+    long long mismatches = 0;
+    for (size_t i = 0; i < numbers.size(); ++i) {
+        bool expected = known[i] >= 0 ? known[i] == 1 : numbers[i].isPrime();
+        mismatches += verdicts[i] != expected;
+    }
+    cout << "primality batch list LargeNumber: " << numbers.size() << " candidates up to "
+         << 64 * numbers.back().nodeCount() << " bits, " << mismatches << " wrong"
+         << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return passed && mismatches == 0;
+}
+
+// Check isPrime(rounds, threads) called from several threads at once, all sharing the
+// same process-wide WorkerPool, on a prime and on a product of two primes
+bool checkParallelPrimality() {
+    const int callers = 4, calls = 40;
+    LargeNumber1024 prime = PrimeSearch<1024>(1).findPrimes(1)[0];
+    vector<FixedLargeNumber<512>> factors = PrimeSearch<512>(1).findPrimes(2);
+    LargeNumber1024 composite = factors[0] * factors[1];
+    atomic<long long> mismatches(0);
+    vector<thread> threads;
+    for (int caller = 0; caller < callers; ++caller) {
+        threads.emplace_back([&] {
+            for (int call = 0; call < calls; ++call) {
+                mismatches += !prime.isPrime(4, 2);
+                mismatches += composite.isPrime(4, 2);
+            }
+        });
+    }
+    for (thread& caller : threads) caller.join();
+    cout << "parallel primality: " << callers << " threads x " << 2 * calls << " isPrime(4, 2) calls, "
+         << mismatches << " wrong" << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return mismatches == 0;
+}
+
+// Function to copy a list LargeNumber of up to 2048 bits into a fixed-width one
+LargeNumber2048 toFixed(const LargeNumber& number) {
+    uint64_t limbs[LargeNumber2048::limb_count];
+    number.copyLimbs(limbs, LargeNumber2048::limb_count);
+    LargeNumber2048 fixed;
+    for (int i = 0; i < LargeNumber2048::limb_count; ++i) fixed.setLimb(i, limbs[i]);
+    return fixed;
+}
+
+// Check list LargeNumber mod and modMul against the fixed-width long division, for
+// divisors from one limb (quotients of nearly 1024 bits) up to the full 1024 bits
+bool checkListDivision() {
+    Xoshiro256StarStar random(7);
+    long long mismatches = 0;
+    int trials = 0;
+    for (int divisorLimbs : {1, 2, 5, 15, 16}) {
+        for (int trial = 0; trial < 20; ++trial, ++trials) {
+            LargeNumber a, b, m;
+            a.generateRandom();
+            b.generateRandom();
+            uint64_t limbs[16];
+            random.fill(limbs, divisorLimbs);
+            limbs[divisorLimbs - 1] |= 1ULL << (random.next() % 64); // Nonzero top limb
+            m.assignLimbs(limbs, divisorLimbs);
+
+            LargeNumber2048 fixedA = toFixed(a), fixedB = toFixed(b), fixedM = toFixed(m);
+            mismatches += !(toFixed(a.mod(m)) == fixedA.mod(fixedM));
+            mismatches += !(toFixed(a.modMul(b, m)) == fixedA.modMul(fixedB, fixedM));
+            LargeNumber reduced = a;
+            reduced %= m;
+            mismatches += !(reduced == a.mod(m)) || reduced >= m;
+        }
+    }
+    // A single-limb modulus against the fixed-width short division
+    LargeNumber a;
+    a.generateRandom();
+    mismatches += !(a.mod(LargeNumber(1000000007)) == LargeNumber(toFixed(a).modSmall(1000000007)));
+    mismatches += !(a.mod(LargeNumber(1)) == LargeNumber(0));
+    cout << "list division: " << 3 * trials + 2 << " mod/modMul cases, " << mismatches << " mismatches"
+         << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return mismatches == 0;
+}
+
+// Function to compute base^exponent mod m for list numbers by binary exponentiation with
+// modMul, the reference for list modPow
+LargeNumber referenceModPow(LargeNumber base, LargeNumber exponent, const LargeNumber& m) {
+    LargeNumber result(1);
+    base %= m;
+    while (!exponent.isZero()) {
+        if (!exponent.isEven()) result = result.modMul(base, m);
+        base = base.modMul(base, m);
+        exponent.divideByTwo();
+    }
+    return result;
+}
+
+// Check list LargeNumber modPow and isPrime, which run on the fixed-width engines up to
+// 4096 bits: modPow against binary exponentiation for odd and even moduli of several
+// widths, isPrime on known primes and composites, and a zero or one modulus at both backends
+bool checkListModPow() {
+    Xoshiro256StarStar random(11);
+    long long mismatches = 0;
+    int cases = 0;
+    for (int modulusLimbs : {1, 3, 16, 17, 32, 33, 64}) {
+        for (bool odd : {true, false}) {
+            uint64_t limbs[64];
+            random.fill(limbs, modulusLimbs);
+            limbs[modulusLimbs - 1] |= 1ULL << 63;
+            limbs[0] = odd ? limbs[0] | 1 : limbs[0] & ~1ULL;
+            LargeNumber m, base, exponent;
+            m.assignLimbs(limbs, modulusLimbs);
+            base.generateRandom();
+            random.fill(limbs, 2); // 128-bit exponent keeps the reference quick
+            exponent.assignLimbs(limbs, 2);
+            mismatches += !(base.modPow(exponent, m) == referenceModPow(base, exponent, m));
+            cases++;
+        }
+    }
+    LargeNumber2048 prime = PrimeSearch<2048>(1).findPrimes(1)[0];
+    uint64_t limbs[32];
+    for (int i = 0; i < 32; ++i) limbs[i] = prime.limb(i);
+    LargeNumber listPrime;
+    listPrime.assignLimbs(limbs, 32);
+    mismatches += !listPrime.isPrime();
+    mismatches += LargeNumber(561).isPrime() || LargeNumber(1).isPrime() || !LargeNumber(3).isPrime();
+    mismatches += !LargeNumber((1ULL << 61) - 1).isPrime();
+    for (uint64_t modulus : {0, 1}) { // Zero and one give zero at both backends, without a BarrettContext
+        mismatches += !LargeNumber(5).modPow(LargeNumber(3), LargeNumber(modulus)).isZero();
+        mismatches += !LargeNumber1024(5).modPow(LargeNumber1024(3), LargeNumber1024(modulus)).isZero();
+        cases += 2;
+    }
+    cout << "list modPow: " << cases << " modPow and 5 isPrime cases, " << mismatches << " mismatches"
+         << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return mismatches == 0;
+}
+
+// Check both MontgomeryContext variants: conversion of values at or above the modulus,
+// squaring against multiplication, and the constant-time modPow against the default one
+bool checkMontgomery() {
+    Xoshiro256StarStar random(13);
+    long long mismatches = 0;
+    int cases = 0;
+    for (int modulusLimbs : {1, 4, 16}) {
+        for (int trial = 0; trial < 10; ++trial, ++cases) {
+            LargeNumber1024 n, a, exponent;
+            for (int i = 0; i < modulusLimbs; ++i) n.setLimb(i, random.next());
+            n.setLimb(0, n.limb(0) | 1);
+            n.setLimb(modulusLimbs - 1, n.limb(modulusLimbs - 1) | 1ULL << 63);
+            a.generateRandom(); // Full width, so usually above n
+            exponent.generateRandom();
+            if (trial == 0) a = n; // Exactly the modulus converts to zero
+            MontgomeryContext<1024> fast(n), constantTime(n, true);
+            LargeNumber1024 residue = a.mod(n);
+            for (const MontgomeryContext<1024>* context : {&fast, &constantTime}) {
+                LargeNumber1024 x = context->toMontgomery(a);
+                mismatches += !(context->fromMontgomery(x) == residue) || x >= n;
+                mismatches += !(context->square(x) == context->multiply(x, x));
+            }
+            mismatches += !(constantTime.modPow(a, exponent) == fast.modPow(a, exponent));
+        }
+    }
+    cout << "montgomery: " << cases << " moduli, each in both variants, " << mismatches << " mismatches"
+         << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return mismatches == 0;
+}
+
+// Check list LargeNumber *= against the schoolbook product of the limbs, for equal and
+// unequal lengths, multiplying a number by itself, and by zero
+bool checkListMultiply() {
+    Xoshiro256StarStar random(17);
+    long long mismatches = 0;
+    int cases = 0;
+    for (int aLimbs : {1, 3, 8, 16}) {
+        for (int bLimbs : {1, 5, 8, 16}) {
+            uint64_t a[16], b[16], expected[32], actual[32];
+            random.fill(a, aLimbs);
+            random.fill(b, bLimbs);
+            a[aLimbs - 1] |= 1; // Nonzero top limbs, so the product has every limb
+            b[bLimbs - 1] |= 1;
+            LargeNumber product, other;
+            product.assignLimbs(a, aLimbs);
+            other.assignLimbs(b, bLimbs);
+            product *= other;
+            multiplyLimbs(a, aLimbs, b, bLimbs, expected);
+            product.copyLimbs(actual, aLimbs + bLimbs);
+            mismatches += !equal(expected, expected + aLimbs + bLimbs, actual);
+
+            LargeNumber square;
+            square.assignLimbs(a, aLimbs);
+            square *= square; // Multiplying by itself
+            multiplyLimbs(a, aLimbs, a, aLimbs, expected);
+            square.copyLimbs(actual, 2 * aLimbs);
+            mismatches += !equal(expected, expected + 2 * aLimbs, actual);
+            cases += 2;
+        }
+    }
+    LargeNumber value;
+    value.generateRandom();
+    value *= LargeNumber(0);
+    mismatches += !value.isZero() || value.nodeCount() != 1;
+    cout << "list multiply: " << cases + 1 << " products, " << mismatches << " mismatches"
+         << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return mismatches == 0;
+}
+
+// Check list LargeNumber >>= against shifting one bit at a time with divideByTwo, for
+// shifts within a node, of whole nodes, and past the top of the number
+bool checkListShift() {
+    long long mismatches = 0;
+    int cases = 0;
+    for (int bits : {0, 1, 5, 63, 64, 65, 127, 128, 200, 640, 1023, 1024, 1100}) {
+        LargeNumber number, expected;
+        number.generateRandom();
+        expected = number;
+        for (int i = 0; i < bits; ++i) expected.divideByTwo();
+        number >>= bits;
+        mismatches += !(number == expected) || number.nodeCount() != expected.nodeCount();
+        cases++;
+    }
+    cout << "list shift: " << cases << " shifts, " << mismatches << " mismatches"
+         << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return mismatches == 0;
+}
+
+// Heap allocations made by op after one warm-up call
+template <typename Op>
+long long countAllocations(Op op) {
+    op(); // Warm-up grows the node arena and the scratch buffers to their peak size
+    long long before = heap_allocations.load();
+    op();
+    return heap_allocations.load() - before;
+}
+
+// Check that warmed-up arithmetic performs no heap allocations: list modMul, *=, %= and
+// modPow (nodes recycled by the NodeArena, limbs in per-thread scratch) and the
+// fixed-width modPow for odd and even moduli
+bool checkAllocations() {
+    LargeNumber listBase, listOther, listModulus, listResult;
+    listBase.generateRandom();
+    listOther.generateRandom();
+    listModulus.generateRandom();
+    LargeNumber listExponent(65537); // Small exponent keeps the list path quick
+
+    LargeNumber1024 base, exponent, m;
+    base.generateRandom();
+    exponent.generateRandom();
+    m.generateRandom();
+    LargeNumber1024 odd = m;
+    odd.setLimb(0, m.limb(0) | 1);
+    LargeNumber1024 even = m;
+    even.setLimb(0, m.limb(0) & ~1ULL);
+    LargeNumber1024 fixedResult;
+
+    vector<pair<string, function<void()>>> operations = {
+        {"list modMul", [&] { listResult = listBase.modMul(listOther, listModulus); }},
+        {"list *=", [&] { listResult = listBase; listResult *= listOther; }},
+        {"list %=", [&] { listResult = listBase; listResult *= listOther; listResult %= listModulus; }},
+        {"list modPow", [&] { listResult = listBase.modPow(listExponent, listModulus); }},
+        {"fixed modPow (montgomery)", [&] { fixedResult = base.modPow(exponent, odd); }},
+        {"fixed modPow (barrett)", [&] { fixedResult = base.modPow(exponent, even); }},
+    };
+    bool passed = true;
+    for (auto& [name, operation] : operations) {
+        long long allocations = countAllocations(operation);
+        cout << "allocations " << name << ": " << allocations << (allocations == 0 ? " (pass)" : " (FAIL)") << endl;
+        passed = passed && allocations == 0;
+    }
+    return passed;
+}
+
+// Check that nodes freed on a thread that has exited are reused: a second thread doing
+// the same work as the first must not take any new slab from the heap
+bool checkNodeArenaReuse() {
+    // Function to build and free a few list numbers, returning the slabs this thread took
+    auto churn = [] {
+        vector<LargeNumber> numbers(40);
+        for (LargeNumber& number : numbers) number.generateRandom();
+        numbers.clear();
+        return NodeArena::local().slabCount();
+    };
+    long long firstSlabs = 0, secondSlabs = 0;
+    thread([&] { firstSlabs = churn(); }).join();
+    thread([&] { secondSlabs = churn(); }).join();
+    cout << "node arena: first thread took " << firstSlabs << " slabs, second thread " << secondSlabs
+         << (secondSlabs == 0 ? " (pass)" : " (FAIL)") << endl;
+    return secondSlabs == 0;
+}
+
+// Check that seedThreadRandom makes threaded work reproducible: pool workers draw the
+// same numbers on every run, and PrimeSearch finds the same primes with one thread or four
+bool checkSeededRandom() {
+    WorkerPool pool(4);
+    vector<uint64_t> first(pool.size()), second(pool.size());
+    seedThreadRandom(21);
+    pool.run([&](int worker) { first[worker] = threadRandom().next(); });
+    seedThreadRandom(21);
+    pool.run([&](int worker) { second[worker] = threadRandom().next(); });
+    long long mismatches = first != second;
+
+    seedThreadRandom(23);
+    vector<FixedLargeNumber<512>> serial = PrimeSearch<512>(1).findPrimes(6);
+    seedThreadRandom(23);
+    vector<FixedLargeNumber<512>> threaded = PrimeSearch<512>(4).findPrimes(6);
+    mismatches += serial != threaded;
+    cout << "seeded random: worker draws and PrimeSearch results " << (mismatches == 0 ? "repeat (pass)" : "differ (FAIL)") << endl;
+    return mismatches == 0;
+}
+
+// Sink that keeps every event and the number of cycles, for comparing schedulers
+class RecordingEventSink : public EventSink {
+public:
+    vector<SchedulerEvent> events;
+    int cycles = 0;
+
+    void cycleStarted(int) override {
+        cycles++;
+    }
+
+    void record(const SchedulerEvent& event) override {
+        events.push_back(event);
+    }
+};
+
+// Function to count the events that differ between two recordings, plus one if the
+// recordings differ in length or in the number of cycles
+long long eventMismatches(const RecordingEventSink& a, const RecordingEventSink& b) {
+    long long mismatches = a.events.size() != b.events.size() || a.cycles != b.cycles;
+    for (size_t i = 0; i < min(a.events.size(), b.events.size()); ++i) {
+        const SchedulerEvent& x = a.events[i];
+        const SchedulerEvent& y = b.events[i];
+        mismatches += x.type != y.type || x.cycle != y.cycle || x.time != y.time || x.process_id != y.process_id
+                      || x.value != y.value;
+    }
+    return mismatches;
+}
+
+// Function to make a reproducible workload that includes zero-length processes
+vector<ProcessSpec> randomWorkload(uint64_t seed, int processes, int maxTime) {
+    Xoshiro256StarStar random(seed);
+    vector<ProcessSpec> specs(processes);
+    for (int i = 0; i < processes; ++i) {
+        specs[i] = {i, (int)(random.next() % (maxTime + 1))};
+    }
+    return specs;
+}
+
+// Check ProcessScheduler on the demo workload (P1 10, P2 5, P3 8) against the schedule
+// worked out by hand: completion order, cycles and finish times, and the metrics
+bool checkRoundRobin() {
+    NullEventSink quiet;
+    vector<CompletionEvent> completions;
+    ProcessScheduler scheduler;
+    scheduler.setEventSink(quiet);
+    scheduler.setCompletionLog(&completions);
+    scheduler.addProcess(1, 10);
+    scheduler.addProcess(2, 5);
+    scheduler.addProcess(3, 8);
+    scheduler.simulate();
+
+    // Cycle 1 runs 3+3+3, cycle 2 runs 3+2+3, cycle 3 runs 3+2, cycle 4 runs the last 1
+    vector<CompletionEvent> expected = {{2, 2, 14}, {3, 3, 22}, {1, 4, 23}};
+    long long mismatches = completions.size() != expected.size();
+    for (size_t i = 0; i < min(completions.size(), expected.size()); ++i) {
+        mismatches += completions[i].process_id != expected[i].process_id || completions[i].cycle != expected[i].cycle
+                      || completions[i].finish_time != expected[i].finish_time;
+    }
+    const SchedulerStats& stats = scheduler.stats();
+    mismatches += stats.cycles != 4 || stats.dispatches != 9 || stats.contextSwitches != 9;
+    mismatches += stats.turnaround.count() != 3 || stats.turnaround.min() != 14 || stats.turnaround.max() != 23
+                  || stats.turnaround.mean() != 59.0 / 3;
+    mismatches += stats.waiting.min() != 9 || stats.waiting.max() != 14 || stats.waiting.mean() != 12;
+    mismatches += stats.response.min() != 0 || stats.response.max() != 6 || stats.response.mean() != 3;
+    mismatches += stats.queueLength.count() != 4 || stats.queueLength.max() != 3 || stats.queueLength.min() != 1;
+    mismatches += stats.cycleContextSwitches.count() != 4 || stats.cycleContextSwitches.min() != 1
+                  || stats.cycleContextSwitches.max() != 3 || stats.cycleContextSwitches.mean() != 9.0 / 4;
+    cout << "round robin: demo workload, " << mismatches << " mismatches" << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return mismatches == 0;
+}
+
+// Check the bucketed Histogram against exact nearest-rank percentiles of the same samples:
+// exact below 16, and within 1/16 above, on small values and on a heavy tail
+bool checkHistogram() {
+    Xoshiro256StarStar random(29);
+    long long mismatches = 0;
+    for (int spread : {16, 1000, 1 << 30}) {
+        Histogram histogram;
+        vector<long long> samples(10000);
+        for (long long& sample : samples) {
+            sample = (long long)(random.next() % spread);
+            if (spread > 1000) sample >>= random.next() % 30;  // Heavy tail
+            histogram.add(sample);
+        }
+        sort(samples.begin(), samples.end());
+        for (double p : {1.0, 50.0, 90.0, 99.0, 99.9, 100.0}) {
+            long long exact = samples[(size_t)ceil(p / 100 * samples.size()) - 1];
+            long long estimate = histogram.percentile(p);
+            mismatches += exact < 16 ? estimate != exact : abs(estimate - exact) > exact / 16;
+        }
+        mismatches += histogram.count() != (long long)samples.size() || histogram.min() != samples.front()
+                      || histogram.max() != samples.back();
+    }
+    cout << "histogram: percentiles of 3 distributions, " << mismatches << " out of bounds"
+         << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return mismatches == 0;
+}
+
+// Check that RingProcessScheduler reports exactly the same events as ProcessScheduler,
+// including processes added between two simulations
+bool checkRingScheduler() {
+    vector<ProcessSpec> specs = randomWorkload(11, 2000, 40);
+    vector<ProcessSpec> later = randomWorkload(12, 300, 40);
+    RecordingEventSink listEvents, ringEvents;
+    ProcessScheduler list;
+    RingProcessScheduler ring;
+    list.setEventSink(listEvents);
+    ring.setEventSink(ringEvents);
+    list.addProcesses(specs);
+    ring.addProcesses(specs);
+    list.simulate();
+    ring.simulate();
+    for (const ProcessSpec& spec : later) {
+        list.addProcess(spec.process_id, spec.execution_time);
+        ring.addProcess(spec.process_id, spec.execution_time);
+    }
+    list.simulate();
+    ring.simulate();
+    long long mismatches = eventMismatches(listEvents, ringEvents);
+    cout << "ring scheduler: " << listEvents.events.size() << " events, " << mismatches << " mismatches"
+         << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return mismatches == 0;
+}
+
+// Check fastForward against the cycle loop: the same completion order, cycles and finish
+// times, from the start of a run and from the middle of one
+bool checkFastForward() {
+    vector<ProcessSpec> specs = randomWorkload(13, 5000, 3000);
+    NullEventSink quiet;
+    vector<CompletionEvent> looped;
+    ProcessScheduler loopScheduler;
+    loopScheduler.setEventSink(quiet);
+    loopScheduler.setCompletionLog(&looped);
+    loopScheduler.addProcesses(specs);
+    loopScheduler.simulate();
+
+    long long mismatches = 0;
+    for (int warmupCycles : {0, 5}) {
+        vector<CompletionEvent> forwarded;
+        ProcessScheduler fastScheduler;
+        fastScheduler.setEventSink(quiet);
+        fastScheduler.setCompletionLog(&forwarded);
+        fastScheduler.addProcesses(specs);
+        for (int cycleCount = 1; cycleCount <= warmupCycles;) {
+            fastScheduler.runCycle(cycleCount);
+        }
+        for (CompletionEvent event : fastScheduler.fastForward()) {
+            event.cycle += warmupCycles;  // fastForward numbers its own cycles from 1
+            forwarded.push_back(event);
+        }
+        mismatches += looped.size() != forwarded.size();
+        for (size_t i = 0; i < min(looped.size(), forwarded.size()); ++i) {
+            mismatches += looped[i].process_id != forwarded[i].process_id || looped[i].cycle != forwarded[i].cycle
+                          || looped[i].finish_time != forwarded[i].finish_time;
+        }
+    }
+    cout << "fast forward: " << specs.size() << " processes, " << mismatches << " mismatches"
+         << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return mismatches == 0;
+}
+
+// Check MultiCoreScheduler against single-queue round robin: with producers adding
+// processes while four cores run and steal, every process must get the same number of
+// quanta and the same CPU time as ProcessScheduler gives it
+bool checkMultiCoreScheduler() {
+    vector<ProcessSpec> specs = randomWorkload(17, 20000, 60);
+    RecordingEventSink singleQueue;
+    ProcessScheduler reference;
+    reference.setEventSink(singleQueue);
+    reference.addProcesses(specs);
+    reference.simulate();
+    vector<int> quanta(specs.size(), 0);
+    vector<long long> cpuTime(specs.size(), 0);
+    for (const SchedulerEvent& event : singleQueue.events) {
+        if (event.type != EventType::Run) continue;
+        quanta[event.process_id]++;
+        cpuTime[event.process_id] += event.value;
+    }
+
+    const int producers = 2;
+    MultiCoreScheduler scheduler(4);
+    scheduler.start();
+    vector<thread> producerThreads;
+    for (int p = 0; p < producers; ++p) {
+        producerThreads.emplace_back([&, p] {
+            for (size_t i = p; i < specs.size(); i += producers) {
+                scheduler.addProcess(specs[i].process_id, specs[i].execution_time);
+            }
+        });
+    }
+    for (thread& producer : producerThreads) producer.join();
+    scheduler.finish();
+
+    vector<CompletedProcess> results = scheduler.results();
+    long long mismatches = results.size() != specs.size();
+    for (size_t i = 0; i < min(results.size(), specs.size()); ++i) {
+        mismatches += results[i].process_id != (int)i || results[i].dispatches != quanta[i]
+                      || results[i].cpu_time != cpuTime[i];
+    }
+    cout << "multicore scheduler: " << results.size() << " processes on 4 cores, " << mismatches
+         << " differ from single-queue round robin" << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return mismatches == 0;
+}
+
+// Check the events PolicyScheduler reports under each policy: every slice is a run event
+// followed by a preempt or complete event for the same process, the run slices of each
+// process add up to its execution time, it completes exactly once, and the completion
+// times give the turnaround in the report
+bool checkPolicyEvents() {
+    Xoshiro256StarStar random(31);
+    vector<ProcessSpec> specs(500);
+    for (int i = 0; i < (int)specs.size(); ++i) {
+        specs[i] = {i, (int)(random.next() % 40), (int)(random.next() % 3), (int)(random.next() % 2000)};
+    }
+    RoundRobinPolicy roundRobin(3);
+    ShortestRemainingTimePolicy shortestRemaining;
+    MultilevelFeedbackPolicy feedback;
+    long long mismatches = 0;
+    for (SchedulingPolicy* policy : initializer_list<SchedulingPolicy*>{&roundRobin, &shortestRemaining, &feedback}) {
+        RecordingEventSink recorded;
+        PolicyScheduler scheduler(*policy);
+        scheduler.setEventSink(recorded);
+        PolicyReport report = scheduler.run(specs);
+
+        vector<long long> cpuTime(specs.size(), 0);
+        vector<int> completions(specs.size(), 0);
+        long long turnaroundSum = 0;
+        const vector<SchedulerEvent>& events = recorded.events;
+        mismatches += events.size() != 2 * (size_t)report.contextSwitches || recorded.cycles != report.contextSwitches;
+        for (size_t i = 0; i + 1 < events.size(); i += 2) {
+            const SchedulerEvent& run = events[i];
+            const SchedulerEvent& after = events[i + 1];
+            mismatches += run.type != EventType::Run || after.type == EventType::Run
+                          || after.process_id != run.process_id || after.time != run.time + run.value;
+            cpuTime[run.process_id] += run.value;
+            if (after.type == EventType::Complete) {
+                completions[after.process_id]++;
+                turnaroundSum += after.time - specs[after.process_id].arrival_time;
+            }
+        }
+        for (size_t i = 0; i < specs.size(); ++i) {
+            mismatches += cpuTime[i] != specs[i].execution_time || completions[i] != 1;
+        }
+        mismatches += abs((double)turnaroundSum / specs.size() - report.averageTurnaround) > 1e-9;
+    }
+    cout << "policy events: RR, SRTF and MLFQ on " << specs.size() << " processes, " << mismatches << " mismatches"
+         << (mismatches == 0 ? " (pass)" : " (FAIL)") << endl;
+    return mismatches == 0;
+}
+
+// A named test; run returns false if any of its checks failed
+struct Test {
+    string name;
+    function<bool()> run;
+};
+
+// Function to list every test, in the order they run
+vector<Test> registerTests() {
+    return {
+        {"allocations", checkAllocations},
+        {"carry_kernels", checkCarryKernels},
+        {"fast_forward", checkFastForward},
+        {"histogram", checkHistogram},
+        {"list_division", checkListDivision},
+        {"list_modpow", checkListModPow},
+        {"list_multiply", checkListMultiply},
+        {"list_shift", checkListShift},
+        {"montgomery", checkMontgomery},
+        {"multicore_scheduler", checkMultiCoreScheduler},
+        {"node_arena", checkNodeArenaReuse},
+        {"parallel_primality", checkParallelPrimality},
+        {"policy_events", checkPolicyEvents},
+        {"primality_batch", checkPrimalityBatch},
+        {"ring_scheduler", checkRingScheduler},
+        {"round_robin", checkRoundRobin},
+        {"seeded_random", checkSeededRandom},
+    };
+}
+
+int main(int argc, char* argv[]) {
+    vector<string> selected(argv + 1, argv + argc);
+    bool list = !selected.empty() && selected[0] == "--list";
+    bool passed = true;
+    int matched = 0;
+    for (const Test& test : registerTests()) {
+        if (list) {
+            cout << test.name << endl;
+            continue;
+        }
+        if (!selected.empty() && find(selected.begin(), selected.end(), test.name) == selected.end()) continue;
+        seedThreadRandom(1);  // Every test sees the same inputs whatever else runs
+        passed = test.run() && passed;
+        matched++;
+    }
+    if (!list && matched == 0) {
+        cout << "No test matches the given names" << endl;
+        return 1;
+    }
+    return passed ? 0 : 1;
+}